@@ -13,6 +13,9 @@
 
 #include "config.h"
 #include "dialog.h"
+#include "qyuvopenglwidget.h"
+#include "qyuvopenglwindow.h"
+#include "yuvshadercache.h"
 #include "thememanager.h"
 #include "mousetap/mousetap.h"
 
@@ -76,6 +79,8 @@ int main(int argc, char *argv[])
     } else if (2 == opengl) {
         QApplication::setAttribute(Qt::AA_UseDesktopOpenGL);
     }
+    // one context group for every video window, they share the YUV programs
+    QApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
 
 #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
@@ -85,6 +90,7 @@ int main(int argc, char *argv[])
 #endif
 #endif
 
+    // GL 2.0 baseline, the fallback when GL3/GLES3 is unavailable
     QSurfaceFormat varFormat = QSurfaceFormat::defaultFormat();
     varFormat.setVersion(2, 0);
     varFormat.setProfile(QSurfaceFormat::NoProfile);
@@ -97,6 +103,8 @@ int main(int argc, char *argv[])
     varFormat.setDepthBufferSize(24);
     */
     QSurfaceFormat::setDefaultFormat(varFormat);
+    // the shared context is created with QApplication, its profile must be final by then
+    YuvGLRenderer::requestRenderBackend(Config::getInstance().getRenderBackend());
 
     g_oldMessageHandler = qInstallMessageHandler(myMessageOutput);
     QApplication a(argc, argv);
@@ -131,6 +139,15 @@ int main(int argc, char *argv[])
 
     qsc::AdbProcess::setAdbPath(Config::getInstance().getAdbPath());
 
+    // checks what the share context got, and must run before any video widget exists
+    YuvGLRenderer::setupRenderBackend(Config::getInstance().getRenderBackend());
+    YuvGLRenderer::setRenderThreadEnabled(0 != Config::getInstance().getRenderThread());
+    YuvVideoRenderer::setPresentPolicy(YuvFramePresenter::policyFromString(Config::getInstance().getPresentPolicy()));
+    YuvGLRenderer::setScaleQuality(yuvScaleQualityFromString(Config::getInstance().getScaleQuality()));
+    QYUVOpenGLWindow::setNativeWindowEnabled(0 == Config::getInstance().getVideoSurface().compare("Window", Qt::CaseInsensitive));
+    QYUVOpenGLWindow::setSwapInterval(Config::getInstance().getSwapInterval());
+    YuvShaderCache::setDiskCacheDir(Config::getInstance().getConfigPath() + "/shadercache");
+
     g_mainDlg = new Dialog {};
     g_mainDlg->show();
 
@@ -0,0 +1,115 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEvent>
+#include <QSurfaceFormat>
+#include <QWidget>
+
+#include "qyuvopenglwindow.h"
+
+namespace {
+bool s_nativeWindowEnabled = false;
+int s_swapInterval = 1;
+} // namespace
+
+void QYUVOpenGLWindow::setNativeWindowEnabled(bool enabled)
+{
+    s_nativeWindowEnabled = enabled;
+}
+
+bool QYUVOpenGLWindow::nativeWindowEnabled()
+{
+    return s_nativeWindowEnabled;
+}
+
+void QYUVOpenGLWindow::setSwapInterval(int interval)
+{
+    s_swapInterval = qMax(0, interval);
+}
+
+QYUVOpenGLWindow::QYUVOpenGLWindow() : QOpenGLWindow(QOpenGLWindow::NoPartialUpdate)
+{
+    // the swap interval is fixed when the platform window is created
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    format.setSwapInterval(s_swapInterval);
+    setFormat(format);
+
+    m_container = QWidget::createWindowContainer(this);
+    m_container->setMinimumSize(50, 50);
+    qInfo() << "Video native window:" << "swapInterval=" << s_swapInterval;
+}
+
+QYUVOpenGLWindow::~QYUVOpenGLWindow()
+{
+    const bool current = isValid();
+    if (current) {
+        makeCurrent();
+    }
+    destroyRenderer();
+    if (current) {
+        doneCurrent();
+    }
+}
+
+QWidget *QYUVOpenGLWindow::widget()
+{
+    return m_container;
+}
+
+QOpenGLContext *QYUVOpenGLWindow::glContext() const
+{
+    return context();
+}
+
+QSize QYUVOpenGLWindow::glLogicalSize() const
+{
+    return size();
+}
+
+qreal QYUVOpenGLWindow::glDevicePixelRatio() const
+{
+    return devicePixelRatio();
+}
+
+void QYUVOpenGLWindow::requestRedraw()
+{
+    // paced by the window's update requests, one paint per refresh
+    update();
+}
+
+void QYUVOpenGLWindow::initializeGL()
+{
+    initializeRenderer();
+}
+
+void QYUVOpenGLWindow::paintGL()
+{
+    paintRenderer();
+}
+
+void QYUVOpenGLWindow::resizeGL(int width, int height)
+{
+    resizeRenderer(width, height);
+}
+
+bool QYUVOpenGLWindow::event(QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+        // a native child window swallows input; the container's position
+        // equals ours, so the event propagates up to VideoForm unchanged
+        if (m_container) {
+            QCoreApplication::sendEvent(m_container, event);
+            return true;
+        }
+        break;
+    default:
+        break;
+    }
+    return QOpenGLWindow::event(event);
+}
@@ -0,0 +1,47 @@
+#ifndef QYUVOPENGLWINDOW_H
+#define QYUVOPENGLWINDOW_H
+#include <QOpenGLWindow>
+#include <QPointer>
+
+#include "yuvglrenderer.h"
+
+// GL renderer drawing into a native QOpenGLWindow embedded with
+// QWidget::createWindowContainer(): frames are swapped straight to the
+// window instead of going through an FBO and the backing store, which saves
+// a full-frame copy and usually a refresh of latency. Widgets can not be
+// stacked on top of the native window. Input is handed to the container
+// so the surrounding widgets see it as before.
+class QYUVOpenGLWindow
+    : public QOpenGLWindow
+    , public YuvGLRenderer
+{
+    Q_OBJECT
+public:
+    // Use this presenter instead of QYUVOpenGLWidget for renderers created afterwards.
+    static void setNativeWindowEnabled(bool enabled);
+    static bool nativeWindowEnabled();
+    // Swap interval of windows created afterwards: 1 waits for vblank,
+    // 0 swaps as soon as a frame is drawn and may tear (meant for fullscreen).
+    static void setSwapInterval(int interval);
+
+    QYUVOpenGLWindow();
+    virtual ~QYUVOpenGLWindow() override;
+
+    // the container widget to lay out, it owns this window
+    QWidget *widget() override;
+
+protected:
+    QOpenGLContext *glContext() const override;
+    QSize glLogicalSize() const override;
+    qreal glDevicePixelRatio() const override;
+    void requestRedraw() override;
+    void initializeGL() override;
+    void paintGL() override;
+    void resizeGL(int width, int height) override;
+    bool event(QEvent *event) override;
+
+private:
+    QPointer<QWidget> m_container;
+};
+
+#endif // QYUVOPENGLWINDOW_H
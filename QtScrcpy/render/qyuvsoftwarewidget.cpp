@@ -0,0 +1,167 @@
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QRegion>
+
+#include "qyuvsoftwarewidget.h"
+#include "yuvdirtybands.h"
+#include "yuvrgbconverter.h"
+
+namespace {
+// painted frames per timing log line
+constexpr int kTimingLogFrames = 600;
+} // namespace
+
+QYUVSoftwareWidget::QYUVSoftwareWidget(QWidget *parent) : QWidget(parent)
+{
+    // every paint covers the whole widget
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+QYUVSoftwareWidget::~QYUVSoftwareWidget() {}
+
+QSize QYUVSoftwareWidget::minimumSizeHint() const
+{
+    return QSize(50, 50);
+}
+
+QSize QYUVSoftwareWidget::sizeHint() const
+{
+    return size();
+}
+
+QWidget *QYUVSoftwareWidget::widget()
+{
+    return this;
+}
+
+QSize QYUVSoftwareWidget::framebufferPixelSize() const
+{
+    const qreal dpr = devicePixelRatioF();
+    return QSize(qRound(width() * dpr), qRound(height() * dpr));
+}
+
+YuvPixelFormat QYUVSoftwareWidget::pixelFormat() const
+{
+    return YuvPixelFormat::I420;
+}
+
+void QYUVSoftwareWidget::convertPresentFrame()
+{
+    if (!m_presenter.take(m_presentFrame)) {
+        return;
+    }
+
+    const VideoFrame &frame = *m_presentFrame;
+    if (frame.format() != YuvPixelFormat::I420 || frame.frameSize() != m_streamFrameSize || !m_streamFrameSize.isValid()) {
+        m_presentFrame.reset();
+        m_imageStale = true;
+        m_presenter.noteDropped();
+        return;
+    }
+
+    if (m_image.size() != m_streamFrameSize) {
+        m_image = QImage(m_streamFrameSize, QImage::Format_RGB32);
+        m_planeLayout = yuvPlaneLayout(YuvPixelFormat::I420, m_streamFrameSize, false);
+        m_imageStale = true;
+    }
+
+    const QBitArray convertBands = m_imageStale ? QBitArray() : frame.dirtyBands();
+    const quint8 *planes[3];
+    quint32 strides[3];
+    frame.planeData(planes, strides);
+
+    // bits() detaches once if a paint still shares the image, later frames write in place
+    uchar *dst = m_image.bits();
+    const int bytesPerLine = static_cast<int>(m_image.bytesPerLine());
+    const QVector<QPair<int, int>> runs = yuvBandRuns(convertBands, yuvBandCount(m_streamFrameSize));
+    for (const QPair<int, int> &run : runs) {
+        yuvI420ToRgb32(planes, strides, m_streamFrameSize, dst, bytesPerLine, run.first * kYuvBandRows, run.second * kYuvBandRows);
+    }
+
+    m_imageStale = false;
+    m_presenter.noteUploaded(yuvBandBytes(m_planeLayout, convertBands), frame.byteCount());
+    const qint64 decodeTimestampUs = frame.decodeTimestampUs();
+    m_presentFrame.reset();
+    m_presenter.notePresented(decodeTimestampUs);
+}
+
+void QYUVSoftwareWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QElapsedTimer timer;
+    timer.start();
+    convertPresentFrame();
+    const qint64 convertNs = timer.nsecsElapsed();
+
+    QPainter painter(this);
+    const QSize canvasSize = effectiveCanvasSize();
+    if (m_image.isNull() || m_image.size() != m_streamFrameSize || !canvasSize.isValid()) {
+        painter.fillRect(rect(), Qt::black);
+        if (!m_overlay.isEmpty()) {
+            yuvDrawOverlay(painter, size(), m_overlay);
+        }
+        return;
+    }
+
+    // same mapping as the GL viewport: the content rect of the canvas, scaled to the widget
+    const QRect contentRect = effectiveContentRect();
+    const qreal scaleX = static_cast<qreal>(width()) / canvasSize.width();
+    const qreal scaleY = static_cast<qreal>(height()) / canvasSize.height();
+    const QRectF target(contentRect.x() * scaleX, contentRect.y() * scaleY, contentRect.width() * scaleX, contentRect.height() * scaleY);
+
+    const QRegion border = QRegion(rect()).subtracted(QRegion(target.toAlignedRect()));
+    for (const QRect &borderRect : border) {
+        painter.fillRect(borderRect, Qt::black);
+    }
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    drawFrameImage(painter, target, QRectF(m_image.rect()));
+    for (int i = 0; i < m_zoomViews.size(); ++i) {
+        const YuvZoomView &view = m_zoomViews.at(i);
+        const QRectF source = unrotatedRect(view.source.normalized().intersected(QRectF(0.0, 0.0, 1.0, 1.0)));
+        const QRectF zoomTarget(view.target.x() * width(), view.target.y() * height(), view.target.width() * width(), view.target.height() * height());
+        drawFrameImage(painter, zoomTarget,
+                       QRectF(source.x() * m_image.width(), source.y() * m_image.height(), source.width() * m_image.width(),
+                              source.height() * m_image.height()));
+    }
+    if (!m_overlay.isEmpty()) {
+        yuvDrawOverlay(painter, size(), m_overlay);
+    }
+
+    logTimings(convertNs, timer.nsecsElapsed() - convertNs);
+}
+
+void QYUVSoftwareWidget::drawFrameImage(QPainter &painter, const QRectF &target, const QRectF &source)
+{
+    if (0 == m_rotation) {
+        painter.drawImage(target, m_image, source);
+        return;
+    }
+
+    painter.save();
+    painter.translate(target.center());
+    painter.rotate(90.0 * m_rotation);
+    const QSizeF size = (m_rotation % 2) ? target.size().transposed() : target.size();
+    painter.drawImage(QRectF(QPointF(-size.width() / 2, -size.height() / 2), size), m_image, source);
+    painter.restore();
+}
+
+void QYUVSoftwareWidget::logTimings(qint64 convertNs, qint64 drawNs)
+{
+    m_convertNsTotal += convertNs;
+    m_drawNsTotal += drawNs;
+    if (++m_timedFrames < kTimingLogFrames) {
+        return;
+    }
+
+    qInfo() << "Software render timings:"
+            << "kernel=" << yuvRgbKernelName(yuvRgbKernel())
+            << "frame=" << m_streamFrameSize
+            << "widgetPixel=" << framebufferPixelSize()
+            << "convertUs=" << m_convertNsTotal / m_timedFrames / 1000
+            << "drawUs=" << m_drawNsTotal / m_timedFrames / 1000;
+    m_convertNsTotal = 0;
+    m_drawNsTotal = 0;
+    m_timedFrames = 0;
+}
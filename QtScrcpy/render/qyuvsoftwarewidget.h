@@ -0,0 +1,52 @@
+#ifndef QYUVSOFTWAREWIDGET_H
+#define QYUVSOFTWAREWIDGET_H
+#include <QImage>
+#include <QVector>
+#include <QWidget>
+
+#include "yuvvideorenderer.h"
+
+// Renderer for machines without usable GL (UseDesktopOpenGL=0 ends up on
+// llvmpipe/WARP): frames are converted to RGB with the SIMD kernels of
+// yuvrgbconverter and drawn with QPainter. Only the dirty bands of a frame
+// are converted, I420 only.
+class QYUVSoftwareWidget
+    : public QWidget
+    , public YuvVideoRenderer
+{
+    Q_OBJECT
+public:
+    explicit QYUVSoftwareWidget(QWidget *parent = nullptr);
+    virtual ~QYUVSoftwareWidget() override;
+
+    QSize minimumSizeHint() const override;
+    QSize sizeHint() const override;
+
+    // QWidget::frameSize() is the window frame, not the stream
+    using YuvVideoRenderer::frameSize;
+    QWidget *widget() override;
+    QSize framebufferPixelSize() const override;
+    YuvPixelFormat pixelFormat() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    void convertPresentFrame();
+    // source pixels of m_image into target, turned by m_rotation
+    void drawFrameImage(QPainter &painter, const QRectF &target, const QRectF &source);
+    void logTimings(qint64 convertNs, qint64 drawNs);
+
+private:
+    // RGB copy of the last converted frame, redrawn as is on resize
+    QImage m_image;
+    QVector<YuvPlaneInfo> m_planeLayout;
+    VideoFrameRef m_presentFrame;
+    // m_image missed changes, convert the next frame in full
+    bool m_imageStale = true;
+    qint64 m_convertNsTotal = 0;
+    qint64 m_drawNsTotal = 0;
+    int m_timedFrames = 0;
+};
+
+#endif // QYUVSOFTWAREWIDGET_H
@@ -0,0 +1,303 @@
+#include <QOpenGLShaderProgram>
+#include <QPainter>
+#include <QVector4D>
+#include <cmath>
+#include <utility>
+
+#include "qyuvwallwidget.h"
+#include "yuvglrenderer.h"
+#include "yuvshadercache.h"
+
+namespace {
+// viewport quad, positions then texture coordinates with the first row on top
+const GLfloat kQuad[] = {
+    -1.0f, -1.0f, 0.0f, 1.0f, -1.0f, 0.0f, -1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f,
+    0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+};
+constexpr int kTileMargin = 4;
+constexpr int kLabelHeight = 18;
+} // namespace
+
+struct QYUVWallWidget::Tile
+{
+    QString id;
+    QString label;
+    // outlives pending, which is declared after it
+    VideoFramePool pool { 2 };
+    VideoFrameRef pending;
+    GLuint textures[3] = { 0, 0, 0 };
+    QVector<YuvPlaneInfo> layout;
+    QSize frameSize;
+};
+
+QYUVWallWidget::QYUVWallWidget(QWidget *parent) : QOpenGLWidget(parent) {}
+
+QYUVWallWidget::~QYUVWallWidget()
+{
+    makeCurrent();
+    for (Tile *tile : m_tiles) {
+        deleteTileTextures(tile);
+    }
+    YuvShaderCache::release(m_program);
+    m_program = nullptr;
+    m_vbo.destroy();
+    m_vao.destroy();
+    doneCurrent();
+    qDeleteAll(m_tiles);
+}
+
+void QYUVWallWidget::addTile(const QString &id)
+{
+    if (hasTile(id)) {
+        return;
+    }
+    Tile *tile = new Tile();
+    tile->id = id;
+    tile->label = id;
+    m_tiles.append(tile);
+    update();
+}
+
+void QYUVWallWidget::removeTile(const QString &id)
+{
+    const int index = tileIndex(id);
+    if (index < 0) {
+        return;
+    }
+    Tile *tile = m_tiles.takeAt(index);
+    if (tile->textures[0]) {
+        makeCurrent();
+        deleteTileTextures(tile);
+        doneCurrent();
+    }
+    delete tile;
+    update();
+}
+
+bool QYUVWallWidget::hasTile(const QString &id) const
+{
+    return tileIndex(id) >= 0;
+}
+
+void QYUVWallWidget::setTileLabel(const QString &id, const QString &label)
+{
+    const int index = tileIndex(id);
+    if (index < 0 || m_tiles[index]->label == label) {
+        return;
+    }
+    m_tiles[index]->label = label;
+    update();
+}
+
+VideoFrameRef QYUVWallWidget::acquireFrame(const QString &id)
+{
+    const int index = tileIndex(id);
+    if (index < 0) {
+        return VideoFrameRef();
+    }
+    return m_tiles[index]->pool.acquire();
+}
+
+void QYUVWallWidget::presentFrame(const QString &id, VideoFrameRef frame)
+{
+    const int index = tileIndex(id);
+    if (index < 0 || !frame) {
+        return;
+    }
+    m_tiles[index]->pending = std::move(frame);
+    update();
+}
+
+QSize QYUVWallWidget::tileFrameSize(const QString &id) const
+{
+    const int index = tileIndex(id);
+    if (index < 0) {
+        return QSize();
+    }
+    const Tile *tile = m_tiles[index];
+    return tile->pending ? tile->pending->frameSize() : tile->frameSize;
+}
+
+QRect QYUVWallWidget::tileVideoRect(const QString &id) const
+{
+    const int index = tileIndex(id);
+    return index < 0 ? QRect() : videoRect(index);
+}
+
+QString QYUVWallWidget::tileAt(const QPoint &pos) const
+{
+    for (int i = 0; i < m_tiles.size(); ++i) {
+        if (videoRect(i).contains(pos)) {
+            return m_tiles[i]->id;
+        }
+    }
+    return QString();
+}
+
+void QYUVWallWidget::initializeGL()
+{
+    initializeOpenGLFunctions();
+    glDisable(GL_DEPTH_TEST);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    // a new context has none of the old textures
+    for (Tile *tile : m_tiles) {
+        tile->textures[0] = tile->textures[1] = tile->textures[2] = 0;
+        tile->layout.clear();
+    }
+
+    m_modernBackend = YuvGLRenderer::modernBackend(context());
+    m_vbo.create();
+    m_vbo.bind();
+    m_vbo.allocate(kQuad, sizeof(kQuad));
+    // core profiles have no default vertex array object
+    if (m_modernBackend) {
+        m_vao.create();
+    }
+
+    QString vertexSource;
+    QString fragmentSource;
+    YuvGLRenderer::shaderSources(context(), m_modernBackend, YuvPixelFormat::I420, YuvScaleQuality::Linear, vertexSource, fragmentSource);
+    YuvShaderCache::release(m_program);
+    m_program = YuvShaderCache::acquire(vertexSource, fragmentSource);
+    if (m_program) {
+        m_program->bind();
+        m_program->setUniformValue("textureY", 0);
+        m_program->setUniformValue("textureU", 1);
+        m_program->setUniformValue("textureV", 2);
+        m_program->release();
+    }
+    m_vbo.release();
+}
+
+void QYUVWallWidget::paintGL()
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (!m_program || m_tiles.isEmpty()) {
+        return;
+    }
+
+    const qreal dpr = devicePixelRatioF();
+    const int framebufferW = qRound(width() * dpr);
+    const int framebufferH = qRound(height() * dpr);
+
+    m_program->bind();
+    if (m_vao.isCreated()) {
+        m_vao.bind();
+    }
+    // the label painter resets the attributes, set them up every paint
+    m_vbo.bind();
+    m_program->setAttributeBuffer("vertexIn", GL_FLOAT, 0, 3, 3 * sizeof(float));
+    m_program->enableAttributeArray("vertexIn");
+    m_program->setAttributeBuffer("textureIn", GL_FLOAT, 12 * sizeof(float), 2, 2 * sizeof(float));
+    m_program->enableAttributeArray("textureIn");
+    // the program is shared with the video windows, which may have left a zoomed part or a rotation
+    m_program->setUniformValue("textureRect", QVector4D(0.0f, 0.0f, 1.0f, 1.0f));
+    m_program->setUniformValue("vertexRotation", YuvGLRenderer::rotationMatrix(0));
+
+    for (int i = 0; i < m_tiles.size(); ++i) {
+        Tile *tile = m_tiles[i];
+        uploadTile(tile);
+        if (!tile->textures[0]) {
+            continue;
+        }
+        const QRect rect = videoRect(i);
+        glViewport(qRound(rect.x() * dpr), framebufferH - qRound((rect.y() + rect.height()) * dpr), qRound(rect.width() * dpr),
+                   qRound(rect.height() * dpr));
+        for (int plane = 0; plane < tile->layout.size(); ++plane) {
+            glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + plane));
+            glBindTexture(GL_TEXTURE_2D, tile->textures[plane]);
+        }
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+    glViewport(0, 0, framebufferW, framebufferH);
+
+    m_vbo.release();
+    if (m_vao.isCreated()) {
+        m_vao.release();
+    }
+    m_program->release();
+
+    QPainter painter(this);
+    painter.setPen(QColor(220, 220, 220));
+    for (int i = 0; i < m_tiles.size(); ++i) {
+        const QRect cell = tileCell(i);
+        const QRect labelRect(cell.left(), cell.bottom() - kLabelHeight + 1, cell.width(), kLabelHeight);
+        painter.drawText(labelRect, Qt::AlignCenter, painter.fontMetrics().elidedText(m_tiles[i]->label, Qt::ElideMiddle, labelRect.width()));
+    }
+}
+
+int QYUVWallWidget::tileIndex(const QString &id) const
+{
+    for (int i = 0; i < m_tiles.size(); ++i) {
+        if (m_tiles[i]->id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QRect QYUVWallWidget::tileCell(int index) const
+{
+    const int count = m_tiles.size();
+    if (count <= 0) {
+        return QRect();
+    }
+    // as square as the window allows, rows filled left to right
+    const int columns = qMax(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count)))));
+    const int rows = (count + columns - 1) / columns;
+    const int cellW = width() / columns;
+    const int cellH = height() / rows;
+    return QRect((index % columns) * cellW, (index / columns) * cellH, cellW, cellH);
+}
+
+QRect QYUVWallWidget::videoRect(int index) const
+{
+    const QRect area = tileCell(index).adjusted(kTileMargin, kTileMargin, -kTileMargin, -kTileMargin - kLabelHeight);
+    if (area.width() <= 0 || area.height() <= 0) {
+        return QRect();
+    }
+    QSize frameSize = tileFrameSize(m_tiles[index]->id);
+    if (!frameSize.isValid() || frameSize.isEmpty()) {
+        // nothing decoded yet, assume a portrait phone
+        frameSize = QSize(9, 16);
+    }
+    const QSize fitted = frameSize.scaled(area.size(), Qt::KeepAspectRatio);
+    return QRect(area.x() + (area.width() - fitted.width()) / 2, area.y() + (area.height() - fitted.height()) / 2, fitted.width(),
+                 fitted.height());
+}
+
+void QYUVWallWidget::uploadTile(Tile *tile)
+{
+    if (!tile->pending) {
+        return;
+    }
+    VideoFrameRef frame = std::move(tile->pending);
+    if (!tile->textures[0] || tile->frameSize != frame->frameSize()) {
+        deleteTileTextures(tile);
+        tile->layout = yuvPlaneLayout(frame->format(), frame->frameSize(), m_modernBackend);
+        if (tile->layout.isEmpty()) {
+            return;
+        }
+        yuvCreateTextures(context(), tile->layout, false, tile->textures);
+        tile->frameSize = frame->frameSize();
+    }
+
+    const quint8 *planes[3] = { nullptr, nullptr, nullptr };
+    quint32 strides[3] = { 0, 0, 0 };
+    frame->planeData(planes, strides);
+    // rows are tightly packed
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    yuvUploadTextures(context(), tile->layout, tile->textures, planes, strides);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void QYUVWallWidget::deleteTileTextures(Tile *tile)
+{
+    if (tile->textures[0]) {
+        glDeleteTextures(static_cast<GLsizei>(tile->layout.size()), tile->textures);
+    }
+    tile->textures[0] = tile->textures[1] = tile->textures[2] = 0;
+    tile->layout.clear();
+    tile->frameSize = QSize();
+}
@@ -0,0 +1,63 @@
+#ifndef QYUVWALLWIDGET_H
+#define QYUVWALLWIDGET_H
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLWidget>
+#include <QVector>
+
+#include "videoframe.h"
+
+class QOpenGLShaderProgram;
+
+// Many streams in one QOpenGLWidget, laid out in a grid. Every tile has its
+// own frame pool and textures, all tiles are drawn with the YUV program of
+// the video windows (shared through YuvShaderCache) in a single paint, and
+// only the newest frame of a tile is uploaded per paint.
+class QYUVWallWidget
+    : public QOpenGLWidget
+    , protected QOpenGLFunctions
+{
+    Q_OBJECT
+public:
+    explicit QYUVWallWidget(QWidget *parent = nullptr);
+    virtual ~QYUVWallWidget() override;
+
+    void addTile(const QString &id);
+    void removeTile(const QString &id);
+    bool hasTile(const QString &id) const;
+    // drawn under the tile's video
+    void setTileLabel(const QString &id, const QString &label);
+
+    // I420 frame from the tile's pool, null when every frame is still referenced
+    VideoFrameRef acquireFrame(const QString &id);
+    // replaces the frame waiting for the next paint of the tile
+    void presentFrame(const QString &id, VideoFrameRef frame);
+    QSize tileFrameSize(const QString &id) const;
+    // letterboxed video area of the tile, in widget coordinates
+    QRect tileVideoRect(const QString &id) const;
+    // tile whose video area contains pos, empty when none
+    QString tileAt(const QPoint &pos) const;
+
+protected:
+    void initializeGL() override;
+    void paintGL() override;
+
+private:
+    struct Tile;
+
+    int tileIndex(const QString &id) const;
+    QRect tileCell(int index) const;
+    QRect videoRect(int index) const;
+    void uploadTile(Tile *tile);
+    void deleteTileTextures(Tile *tile);
+
+    QVector<Tile *> m_tiles;
+    bool m_modernBackend = false;
+    // shared with the video windows of the context group
+    QOpenGLShaderProgram *m_program = nullptr;
+    QOpenGLBuffer m_vbo;
+    QOpenGLVertexArrayObject m_vao;
+};
+
+#endif // QYUVWALLWIDGET_H
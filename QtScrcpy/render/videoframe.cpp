@@ -0,0 +1,277 @@
+#include <QDebug>
+#include <QElapsedTimer>
+#include <cstring>
+#include <utility>
+
+#include "videoframe.h"
+
+YuvPixelFormat VideoFrame::format() const
+{
+    return m_format;
+}
+
+const QSize &VideoFrame::frameSize() const
+{
+    return m_frameSize;
+}
+
+int VideoFrame::planeCount() const
+{
+    return m_planeCount;
+}
+
+const quint8 *VideoFrame::plane(int index) const
+{
+    if (index < 0 || index >= m_planeCount) {
+        return nullptr;
+    }
+    return reinterpret_cast<const quint8 *>(m_planes[index].constData());
+}
+
+quint32 VideoFrame::stride(int index) const
+{
+    if (index < 0 || index >= m_planeCount) {
+        return 0;
+    }
+    return m_strides[index];
+}
+
+void VideoFrame::planeData(const quint8 *data[3], quint32 strides[3]) const
+{
+    for (int i = 0; i < 3; ++i) {
+        data[i] = plane(i);
+        strides[i] = stride(i);
+    }
+}
+
+qint64 VideoFrame::byteCount() const
+{
+    qint64 bytes = 0;
+    for (int i = 0; i < m_planeCount; ++i) {
+        bytes += m_planes[i].size();
+    }
+    return bytes;
+}
+
+const QBitArray &VideoFrame::dirtyBands() const
+{
+    return m_dirtyBands;
+}
+
+void VideoFrame::setDirtyBands(const QBitArray &dirtyBands)
+{
+    m_dirtyBands = dirtyBands;
+}
+
+bool VideoFrame::hasChanges() const
+{
+    return m_dirtyBands.isEmpty() || m_dirtyBands.count(true) > 0;
+}
+
+qint64 VideoFrame::pts() const
+{
+    return m_pts;
+}
+
+void VideoFrame::setPts(qint64 pts)
+{
+    m_pts = pts;
+}
+
+qint64 VideoFrame::decodeTimestampUs() const
+{
+    return m_decodeTimestampUs;
+}
+
+bool VideoFrame::fill(YuvPixelFormat format, const QSize &frameSize, const quint8 *const planes[3], const quint32 strides[3],
+                      const QRect &sourceRect)
+{
+    QRect copyRect(QPoint(0, 0), frameSize);
+    if (sourceRect.isValid()) {
+        // 4:2:0 chroma covers 2x2 luma pixels, keep the rect on that grid
+        const int left = sourceRect.left() & ~1;
+        const int top = sourceRect.top() & ~1;
+        QRect aligned(left, top, (sourceRect.right() + 1 - left + 1) & ~1, (sourceRect.bottom() + 1 - top + 1) & ~1);
+        aligned = aligned.intersected(copyRect);
+        if (aligned.width() >= 2 && aligned.height() >= 2) {
+            aligned.setWidth(aligned.width() & ~1);
+            aligned.setHeight(aligned.height() & ~1);
+            copyRect = aligned;
+        }
+    }
+
+    // plane geometry does not depend on the texture flavour, only on the format
+    const QVector<YuvPlaneInfo> layout = yuvPlaneLayout(format, copyRect.size(), true);
+    m_planeCount = 0;
+    if (layout.isEmpty()) {
+        return false;
+    }
+    for (int i = 0; i < layout.size(); ++i) {
+        if (!planes[i]) {
+            return false;
+        }
+    }
+
+    m_format = format;
+    m_frameSize = copyRect.size();
+    m_dirtyBands.clear();
+    m_pts = -1;
+    m_decodeTimestampUs = VideoFramePool::clockUs();
+
+    for (int i = 0; i < layout.size(); ++i) {
+        const YuvPlaneInfo &plane = layout[i];
+        const int rowBytes = plane.size.width() * plane.bytesPerPixel;
+        QByteArray &buffer = m_planes[i];
+        // same size as last time in steady state, no reallocation
+        buffer.resize(rowBytes * plane.size.height());
+        m_strides[i] = static_cast<quint32>(rowBytes);
+
+        const int planeX = 0 == i ? copyRect.x() : copyRect.x() / 2;
+        const int planeY = 0 == i ? copyRect.y() : copyRect.y() / 2;
+        char *dst = buffer.data();
+        const quint8 *src = planes[i] + static_cast<qptrdiff>(planeY) * strides[i] + planeX * plane.bytesPerPixel;
+        if (static_cast<int>(strides[i]) == rowBytes) {
+            memcpy(dst, src, static_cast<size_t>(buffer.size()));
+        } else {
+            for (int row = 0; row < plane.size.height(); ++row) {
+                memcpy(dst, src, static_cast<size_t>(rowBytes));
+                dst += rowBytes;
+                src += strides[i];
+            }
+        }
+    }
+    m_planeCount = layout.size();
+    return true;
+}
+
+VideoFrame::VideoFrame(VideoFramePool *pool) : m_pool(pool) {}
+
+VideoFrameRef::VideoFrameRef(VideoFrame *frame) : m_frame(frame) {}
+
+VideoFrameRef::VideoFrameRef(const VideoFrameRef &other) : m_frame(other.m_frame)
+{
+    if (m_frame) {
+        m_frame->m_ref.ref();
+    }
+}
+
+VideoFrameRef::VideoFrameRef(VideoFrameRef &&other) noexcept : m_frame(other.m_frame)
+{
+    other.m_frame = nullptr;
+}
+
+VideoFrameRef::~VideoFrameRef()
+{
+    reset();
+}
+
+VideoFrameRef &VideoFrameRef::operator=(const VideoFrameRef &other)
+{
+    if (m_frame != other.m_frame) {
+        VideoFrameRef copy(other);
+        std::swap(m_frame, copy.m_frame);
+    }
+    return *this;
+}
+
+VideoFrameRef &VideoFrameRef::operator=(VideoFrameRef &&other) noexcept
+{
+    if (this != &other) {
+        reset();
+        m_frame = other.m_frame;
+        other.m_frame = nullptr;
+    }
+    return *this;
+}
+
+bool VideoFrameRef::isNull() const
+{
+    return !m_frame;
+}
+
+VideoFrameRef::operator bool() const
+{
+    return m_frame != nullptr;
+}
+
+VideoFrame *VideoFrameRef::operator->() const
+{
+    return m_frame;
+}
+
+VideoFrame &VideoFrameRef::operator*() const
+{
+    return *m_frame;
+}
+
+void VideoFrameRef::reset()
+{
+    if (m_frame && !m_frame->m_ref.deref()) {
+        m_frame->m_pool->recycle(m_frame);
+    }
+    m_frame = nullptr;
+}
+
+VideoFramePool::VideoFramePool(int capacity) : m_capacity(qMax(1, capacity)) {}
+
+VideoFramePool::~VideoFramePool()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_freeFrames.size() != m_allocated) {
+        // the remaining frames are leaked rather than freed under their users
+        qWarning() << "VideoFramePool destroyed with frames in use:" << m_allocated - m_freeFrames.size();
+    }
+    qDeleteAll(m_freeFrames);
+    m_freeFrames.clear();
+}
+
+qint64 VideoFramePool::clockUs()
+{
+    static const QElapsedTimer s_clock = []() {
+        QElapsedTimer clock;
+        clock.start();
+        return clock;
+    }();
+    return s_clock.nsecsElapsed() / 1000;
+}
+
+VideoFrameRef VideoFramePool::acquire()
+{
+    QMutexLocker locker(&m_mutex);
+    VideoFrame *frame = nullptr;
+    if (!m_freeFrames.isEmpty()) {
+        frame = m_freeFrames.takeLast();
+    } else if (m_allocated < m_capacity) {
+        frame = new VideoFrame(this);
+        ++m_allocated;
+    } else {
+        ++m_exhausted;
+        return VideoFrameRef();
+    }
+
+    frame->m_ref.ref();
+    return VideoFrameRef(frame);
+}
+
+int VideoFramePool::capacity() const
+{
+    return m_capacity;
+}
+
+int VideoFramePool::inUse() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_allocated - m_freeFrames.size();
+}
+
+quint64 VideoFramePool::exhaustedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_exhausted;
+}
+
+void VideoFramePool::recycle(VideoFrame *frame)
+{
+    QMutexLocker locker(&m_mutex);
+    m_freeFrames.append(frame);
+}
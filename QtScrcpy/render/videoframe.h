@@ -0,0 +1,120 @@
+#ifndef VIDEOFRAME_H
+#define VIDEOFRAME_H
+
+#include <QAtomicInt>
+#include <QBitArray>
+#include <QByteArray>
+#include <QMutex>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+
+#include "yuvformat.h"
+
+class VideoFramePool;
+
+// One decoded frame in pooled storage. Planes are packed tightly, so the
+// stride of a plane is its row size in bytes.
+class VideoFrame
+{
+public:
+    YuvPixelFormat format() const;
+    const QSize &frameSize() const;
+    int planeCount() const;
+    const quint8 *plane(int index) const;
+    quint32 stride(int index) const;
+    void planeData(const quint8 *data[3], quint32 strides[3]) const;
+    qint64 byteCount() const;
+
+    // bands that differ from the frame before it (see yuvdirtybands.h), empty
+    // when unknown so everything has to be uploaded
+    const QBitArray &dirtyBands() const;
+    void setDirtyBands(const QBitArray &dirtyBands);
+    bool hasChanges() const;
+
+    // presentation timestamp in microseconds, -1 when the source has none
+    qint64 pts() const;
+    void setPts(qint64 pts);
+    // monotonic time the frame left the decoder, see VideoFramePool::clockUs()
+    qint64 decodeTimestampUs() const;
+
+    // Copies the decoder planes in, reusing the buffers of earlier frames.
+    // A valid sourceRect keeps only that part of the frame (snapped to even
+    // coordinates for the subsampled chroma), frameSize() is then its size.
+    bool fill(YuvPixelFormat format, const QSize &frameSize, const quint8 *const planes[3], const quint32 strides[3],
+              const QRect &sourceRect = QRect());
+
+private:
+    friend class VideoFramePool;
+    friend class VideoFrameRef;
+
+    explicit VideoFrame(VideoFramePool *pool);
+    ~VideoFrame() = default;
+    Q_DISABLE_COPY(VideoFrame)
+
+    VideoFramePool *m_pool = nullptr;
+    QAtomicInt m_ref;
+    YuvPixelFormat m_format = YuvPixelFormat::I420;
+    QSize m_frameSize;
+    int m_planeCount = 0;
+    QByteArray m_planes[3];
+    quint32 m_strides[3] = { 0, 0, 0 };
+    QBitArray m_dirtyBands;
+    qint64 m_pts = -1;
+    qint64 m_decodeTimestampUs = 0;
+};
+
+// Shared handle to a pooled frame, the frame goes back to its pool when the
+// last handle is released. Copying a handle never copies pixels.
+class VideoFrameRef
+{
+public:
+    VideoFrameRef() = default;
+    VideoFrameRef(const VideoFrameRef &other);
+    VideoFrameRef(VideoFrameRef &&other) noexcept;
+    ~VideoFrameRef();
+    VideoFrameRef &operator=(const VideoFrameRef &other);
+    VideoFrameRef &operator=(VideoFrameRef &&other) noexcept;
+
+    bool isNull() const;
+    explicit operator bool() const;
+    VideoFrame *operator->() const;
+    VideoFrame &operator*() const;
+    void reset();
+
+private:
+    friend class VideoFramePool;
+    explicit VideoFrameRef(VideoFrame *frame);
+
+    VideoFrame *m_frame = nullptr;
+};
+
+// Fixed number of frames shared between the decoder callback and the
+// renderer. acquire() never blocks: when every frame is still referenced it
+// returns a null handle and the caller drops the frame, so memory stays
+// bounded by capacity * frame size. The pool must outlive its handles.
+class VideoFramePool
+{
+public:
+    explicit VideoFramePool(int capacity = 4);
+    ~VideoFramePool();
+
+    static qint64 clockUs();
+
+    VideoFrameRef acquire();
+    int capacity() const;
+    int inUse() const;
+    quint64 exhaustedCount() const;
+
+private:
+    friend class VideoFrameRef;
+    void recycle(VideoFrame *frame);
+
+    mutable QMutex m_mutex;
+    const int m_capacity;
+    int m_allocated = 0;
+    QVector<VideoFrame *> m_freeFrames;
+    quint64 m_exhausted = 0;
+};
+
+#endif // VIDEOFRAME_H
@@ -0,0 +1,148 @@
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YUV_DIRTY_BANDS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define YUV_DIRTY_BANDS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "videoframe.h"
+#include "yuvdirtybands.h"
+
+namespace {
+bool blocksEqual(const quint8 *a, const quint8 *b, size_t bytes)
+{
+    size_t offset = 0;
+#if defined(YUV_DIRTY_BANDS_SSE2)
+    // 64 bytes per iteration, one branch per cache line
+    for (; offset + 64 <= bytes; offset += 64) {
+        const __m128i d0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + offset)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + offset)));
+        const __m128i d1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + offset + 16)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + offset + 16)));
+        const __m128i d2 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + offset + 32)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + offset + 32)));
+        const __m128i d3 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + offset + 48)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + offset + 48)));
+        const __m128i diff = _mm_or_si128(_mm_or_si128(d0, d1), _mm_or_si128(d2, d3));
+        if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128()))) {
+            return false;
+        }
+    }
+#elif defined(YUV_DIRTY_BANDS_NEON)
+    for (; offset + 64 <= bytes; offset += 64) {
+        const uint8x16_t d0 = veorq_u8(vld1q_u8(a + offset), vld1q_u8(b + offset));
+        const uint8x16_t d1 = veorq_u8(vld1q_u8(a + offset + 16), vld1q_u8(b + offset + 16));
+        const uint8x16_t d2 = veorq_u8(vld1q_u8(a + offset + 32), vld1q_u8(b + offset + 32));
+        const uint8x16_t d3 = veorq_u8(vld1q_u8(a + offset + 48), vld1q_u8(b + offset + 48));
+        const uint64x2_t diff = vreinterpretq_u64_u8(vorrq_u8(vorrq_u8(d0, d1), vorrq_u8(d2, d3)));
+        if (0 != (vgetq_lane_u64(diff, 0) | vgetq_lane_u64(diff, 1))) {
+            return false;
+        }
+    }
+#endif
+    return 0 == memcmp(a + offset, b + offset, bytes - offset);
+}
+} // namespace
+
+int yuvBandCount(const QSize &frameSize)
+{
+    if (frameSize.height() <= 0) {
+        return 0;
+    }
+    return (frameSize.height() + kYuvBandRows - 1) / kYuvBandRows;
+}
+
+int yuvPlaneBandRows(int plane)
+{
+    return 0 == plane ? kYuvBandRows : kYuvBandRows / 2;
+}
+
+QVector<QPair<int, int>> yuvBandRuns(const QBitArray &dirtyBands, int bandCount)
+{
+    QVector<QPair<int, int>> runs;
+    if (dirtyBands.isEmpty() || dirtyBands.size() != bandCount) {
+        if (bandCount > 0) {
+            runs.append(qMakePair(0, bandCount));
+        }
+        return runs;
+    }
+
+    int band = 0;
+    while (band < bandCount) {
+        if (!dirtyBands.testBit(band)) {
+            ++band;
+            continue;
+        }
+        const int first = band;
+        while (band < bandCount && dirtyBands.testBit(band)) {
+            ++band;
+        }
+        runs.append(qMakePair(first, band));
+    }
+    return runs;
+}
+
+qint64 yuvBandBytes(const QVector<YuvPlaneInfo> &planes, const QBitArray &dirtyBands)
+{
+    if (planes.isEmpty()) {
+        return 0;
+    }
+
+    const int bandCount = yuvBandCount(planes[0].size);
+    const QVector<QPair<int, int>> runs = yuvBandRuns(dirtyBands, bandCount);
+    qint64 bytes = 0;
+    for (int i = 0; i < planes.size(); ++i) {
+        const YuvPlaneInfo &plane = planes[i];
+        const qint64 rowBytes = static_cast<qint64>(plane.size.width()) * plane.bytesPerPixel;
+        const int bandRows = yuvPlaneBandRows(i);
+        for (const QPair<int, int> &run : runs) {
+            const int firstRow = qMin(run.first * bandRows, plane.size.height());
+            const int endRow = qMin(run.second * bandRows, plane.size.height());
+            bytes += rowBytes * (endRow - firstRow);
+        }
+    }
+    return bytes;
+}
+
+bool yuvDiffBands(const VideoFrame &previous, const VideoFrame &current, QBitArray &dirtyBands)
+{
+    dirtyBands.clear();
+    if (previous.format() != current.format() || previous.frameSize() != current.frameSize()
+        || previous.planeCount() != current.planeCount() || current.planeCount() <= 0) {
+        return false;
+    }
+
+    const QVector<YuvPlaneInfo> planes = yuvPlaneLayout(current.format(), current.frameSize(), true);
+    const int bandCount = yuvBandCount(current.frameSize());
+    dirtyBands.resize(bandCount);
+    for (int band = 0; band < bandCount; ++band) {
+        for (int i = 0; i < planes.size(); ++i) {
+            const int bandRows = yuvPlaneBandRows(i);
+            const int firstRow = qMin(band * bandRows, planes[i].size.height());
+            const int endRow = qMin(firstRow + bandRows, planes[i].size.height());
+            // pooled frames are tightly packed, a band is one contiguous block
+            const size_t offset = static_cast<size_t>(current.stride(i)) * firstRow;
+            const size_t bytes = static_cast<size_t>(current.stride(i)) * (endRow - firstRow);
+            if (!blocksEqual(previous.plane(i) + offset, current.plane(i) + offset, bytes)) {
+                dirtyBands.setBit(band);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+void yuvMergeBands(QBitArray &dirtyBands, const QBitArray &otherBands)
+{
+    if (dirtyBands.isEmpty()) {
+        return;
+    }
+    if (otherBands.size() != dirtyBands.size()) {
+        dirtyBands.clear();
+        return;
+    }
+    dirtyBands |= otherBands;
+}
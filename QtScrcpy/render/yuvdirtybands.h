@@ -0,0 +1,32 @@
+#ifndef YUVDIRTYBANDS_H
+#define YUVDIRTYBANDS_H
+
+#include <QBitArray>
+#include <QPair>
+#include <QSize>
+#include <QVector>
+
+#include "yuvformat.h"
+
+class VideoFrame;
+
+// Frames are compared and uploaded in horizontal bands of kYuvBandRows luma
+// rows; the 4:2:0 chroma planes cover the same band with half as many rows.
+// A dirty band mask has one bit per band, an empty mask means "everything".
+constexpr int kYuvBandRows = 16;
+
+int yuvBandCount(const QSize &frameSize);
+int yuvPlaneBandRows(int plane);
+// [first, end) band ranges of consecutive dirty bands
+QVector<QPair<int, int>> yuvBandRuns(const QBitArray &dirtyBands, int bandCount);
+// bytes of the tightly packed planes covered by the dirty bands
+qint64 yuvBandBytes(const QVector<YuvPlaneInfo> &planes, const QBitArray &dirtyBands);
+
+// Marks the bands whose pixels differ between two frames of the same format
+// and size (SSE2/NEON compare). Returns false and leaves an empty, all dirty
+// mask when the frames can not be compared.
+bool yuvDiffBands(const VideoFrame &previous, const VideoFrame &current, QBitArray &dirtyBands);
+// OR of two masks of the same frame geometry, empty if either one is
+void yuvMergeBands(QBitArray &dirtyBands, const QBitArray &otherBands);
+
+#endif // YUVDIRTYBANDS_H
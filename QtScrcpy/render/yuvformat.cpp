@@ -0,0 +1,187 @@
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+
+#include "yuvdirtybands.h"
+#include "yuvformat.h"
+
+// sized formats are not declared by ES 2.0 headers
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_RG
+#define GL_RG 0x8227
+#endif
+#ifndef GL_R8
+#define GL_R8 0x8229
+#endif
+#ifndef GL_R16
+#define GL_R16 0x822A
+#endif
+#ifndef GL_RG8
+#define GL_RG8 0x822B
+#endif
+#ifndef GL_RG16
+#define GL_RG16 0x822C
+#endif
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+
+namespace {
+YuvPlaneInfo makePlane(const QSize &size, int bytesPerPixel, GLint internalFormat, GLenum format, GLenum type)
+{
+    YuvPlaneInfo plane;
+    plane.size = size;
+    plane.bytesPerPixel = bytesPerPixel;
+    plane.internalFormat = internalFormat;
+    plane.format = format;
+    plane.type = type;
+    return plane;
+}
+} // namespace
+
+QVector<YuvPlaneInfo> yuvPlaneLayout(YuvPixelFormat format, const QSize &frameSize, bool modernTextures)
+{
+    QVector<YuvPlaneInfo> planes;
+    if (frameSize.width() <= 0 || frameSize.height() <= 0) {
+        return planes;
+    }
+
+    const QSize chromaSize = frameSize / 2;
+    switch (format) {
+    case YuvPixelFormat::NV12:
+        // two-channel and 16-bit normalized textures only exist on the modern backend
+        if (modernTextures) {
+            planes.append(makePlane(frameSize, 1, GL_R8, GL_RED, GL_UNSIGNED_BYTE));
+            planes.append(makePlane(chromaSize, 2, GL_RG8, GL_RG, GL_UNSIGNED_BYTE));
+        }
+        break;
+    case YuvPixelFormat::P010:
+        if (modernTextures) {
+            planes.append(makePlane(frameSize, 2, GL_R16, GL_RED, GL_UNSIGNED_SHORT));
+            planes.append(makePlane(chromaSize, 4, GL_RG16, GL_RG, GL_UNSIGNED_SHORT));
+        }
+        break;
+    case YuvPixelFormat::I420:
+    default:
+        for (int i = 0; i < 3; ++i) {
+            const QSize size = 0 == i ? frameSize : chromaSize;
+            if (modernTextures) {
+                planes.append(makePlane(size, 1, GL_R8, GL_RED, GL_UNSIGNED_BYTE));
+            } else {
+                planes.append(makePlane(size, 1, GL_LUMINANCE, GL_LUMINANCE, GL_UNSIGNED_BYTE));
+            }
+        }
+        break;
+    }
+    return planes;
+}
+
+const char *yuvPixelFormatName(YuvPixelFormat format)
+{
+    switch (format) {
+    case YuvPixelFormat::NV12:
+        return "NV12";
+    case YuvPixelFormat::P010:
+        return "P010";
+    case YuvPixelFormat::I420:
+    default:
+        return "I420";
+    }
+}
+
+YuvScaleQuality yuvScaleQualityFromString(const QString &quality)
+{
+    const QString value = quality.trimmed();
+    if (0 == value.compare("Mipmap", Qt::CaseInsensitive)) {
+        return YuvScaleQuality::Mipmap;
+    }
+    if (0 == value.compare("Bicubic", Qt::CaseInsensitive)) {
+        return YuvScaleQuality::Bicubic;
+    }
+    return YuvScaleQuality::Linear;
+}
+
+const char *yuvScaleQualityName(YuvScaleQuality quality)
+{
+    switch (quality) {
+    case YuvScaleQuality::Mipmap:
+        return "Mipmap";
+    case YuvScaleQuality::Bicubic:
+        return "Bicubic";
+    case YuvScaleQuality::Linear:
+    default:
+        return "Linear";
+    }
+}
+
+int yuvMipLevels(const QSize &size)
+{
+    int levels = 1;
+    for (int extent = qMax(size.width(), size.height()); extent > 1; extent /= 2) {
+        ++levels;
+    }
+    return levels;
+}
+
+void yuvCreateTextures(QOpenGLContext *context, const QVector<YuvPlaneInfo> &planes, bool immutableStorage, GLuint textures[3], bool mipmaps)
+{
+    QOpenGLExtraFunctions *functions = context->extraFunctions();
+    functions->glGenTextures(planes.size(), textures);
+    for (int i = 0; i < planes.size(); ++i) {
+        const YuvPlaneInfo &plane = planes[i];
+        functions->glBindTexture(GL_TEXTURE_2D, textures[i]);
+        functions->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        functions->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        functions->glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        functions->glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        if (immutableStorage) {
+            // immutable storage lets the driver skip per-upload completeness checks
+            const int levels = mipmaps ? yuvMipLevels(plane.size) : 1;
+            functions->glTexStorage2D(GL_TEXTURE_2D, levels, static_cast<GLenum>(plane.internalFormat), plane.size.width(), plane.size.height());
+        } else {
+            functions->glTexImage2D(GL_TEXTURE_2D, 0, plane.internalFormat, plane.size.width(), plane.size.height(), 0, plane.format, plane.type, nullptr);
+        }
+    }
+}
+
+void yuvUploadTextures(QOpenGLContext *context, const QVector<YuvPlaneInfo> &planes, const GLuint textures[3], const quint8 *const data[3], const quint32 strides[3],
+                       const QBitArray &dirtyBands)
+{
+    if (planes.isEmpty()) {
+        return;
+    }
+
+    QOpenGLFunctions *functions = context->functions();
+    const QVector<QPair<int, int>> runs = yuvBandRuns(dirtyBands, yuvBandCount(planes[0].size));
+    for (int i = 0; i < planes.size(); ++i) {
+        if (!data[i]) {
+            continue;
+        }
+        const YuvPlaneInfo &plane = planes[i];
+        const int bandRows = yuvPlaneBandRows(i);
+        functions->glBindTexture(GL_TEXTURE_2D, textures[i]);
+        // row length is counted in pixels, stride in bytes
+        functions->glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(strides[i]) / plane.bytesPerPixel);
+        for (const QPair<int, int> &run : runs) {
+            const int firstRow = qMin(run.first * bandRows, plane.size.height());
+            const int endRow = qMin(run.second * bandRows, plane.size.height());
+            if (endRow <= firstRow) {
+                continue;
+            }
+            functions->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, plane.size.width(), endRow - firstRow, plane.format, plane.type,
+                                       data[i] + static_cast<qptrdiff>(firstRow) * strides[i]);
+        }
+    }
+    functions->glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void yuvGenerateMipmaps(QOpenGLContext *context, const QVector<YuvPlaneInfo> &planes, const GLuint textures[3])
+{
+    QOpenGLFunctions *functions = context->functions();
+    for (int i = 0; i < planes.size(); ++i) {
+        functions->glBindTexture(GL_TEXTURE_2D, textures[i]);
+        // the whole chain, a partial upload still changes every level
+        functions->glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef YUVFORMAT_H
+#define YUVFORMAT_H
+
+#include <QBitArray>
+#include <QSize>
+#include <QString>
+#include <QVector>
+#include <qopengl.h>
+
+class QOpenGLContext;
+
+enum class YuvPixelFormat
+{
+    I420 = 0, // 8-bit Y, U, V planes
+    NV12,     // 8-bit Y plane + interleaved UV plane
+    P010,     // 10-bit in the high bits of 16-bit words, Y plane + interleaved UV plane
+};
+
+// How frames are filtered when the widget is smaller (or larger) than the stream.
+enum class YuvScaleQuality
+{
+    Linear = 0, // bilinear, aliases when shrinking by more than 2x
+    Mipmap,     // trilinear from a mip chain regenerated after every upload
+    Bicubic,    // B-spline bicubic on the mip level matching the window size
+};
+
+struct YuvPlaneInfo
+{
+    QSize size;
+    int bytesPerPixel = 1;
+    GLint internalFormat = 0;
+    GLenum format = 0;
+    GLenum type = 0;
+};
+
+// Texture layout of one frame, empty if the format can not be represented.
+// Legacy textures (GL 2.0 / ES 2.0) only cover I420 with GL_LUMINANCE planes,
+// modern ones use sized R8/RG8/R16/RG16 storage.
+QVector<YuvPlaneInfo> yuvPlaneLayout(YuvPixelFormat format, const QSize &frameSize, bool modernTextures);
+const char *yuvPixelFormatName(YuvPixelFormat format);
+YuvScaleQuality yuvScaleQualityFromString(const QString &quality);
+const char *yuvScaleQualityName(YuvScaleQuality quality);
+// levels of a full mip chain down to 1x1
+int yuvMipLevels(const QSize &size);
+
+// All expect context to be current. Immutable storage needs GL 4.2 / ES 3.0
+// or GL_ARB_texture_storage, strides are in bytes. A non-empty dirtyBands
+// mask limits the upload to those bands (see yuvdirtybands.h). Mipmapped
+// textures (modern backend only) need yuvGenerateMipmaps() after each upload.
+void yuvCreateTextures(QOpenGLContext *context, const QVector<YuvPlaneInfo> &planes, bool immutableStorage, GLuint textures[3], bool mipmaps = false);
+void yuvUploadTextures(QOpenGLContext *context, const QVector<YuvPlaneInfo> &planes, const GLuint textures[3], const quint8 *const data[3], const quint32 strides[3],
+                       const QBitArray &dirtyBands = QBitArray());
+void yuvGenerateMipmaps(QOpenGLContext *context, const QVector<YuvPlaneInfo> &planes, const GLuint textures[3]);
+
+#endif // YUVFORMAT_H
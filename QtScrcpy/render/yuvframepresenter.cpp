@@ -0,0 +1,134 @@
+#include <QElapsedTimer>
+#include <utility>
+
+#include "yuvdirtybands.h"
+#include "yuvframepresenter.h"
+
+YuvFramePresenter::Policy YuvFramePresenter::policyFromString(const QString &policy)
+{
+    if (0 == policy.trimmed().compare("LowLatency", Qt::CaseInsensitive)) {
+        return Policy::LowLatency;
+    }
+    return Policy::Smooth;
+}
+
+const char *YuvFramePresenter::policyName(Policy policy)
+{
+    return Policy::LowLatency == policy ? "LowLatency" : "Smooth";
+}
+
+void YuvFramePresenter::setPolicy(Policy policy)
+{
+    QMutexLocker locker(&m_mutex);
+    m_policy = policy;
+}
+
+YuvFramePresenter::Policy YuvFramePresenter::policy() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_policy;
+}
+
+bool YuvFramePresenter::submit(VideoFrameRef frame)
+{
+    VideoFrameRef replaced;
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_stats.received;
+        if (!frame || frame->planeCount() <= 0) {
+            ++m_stats.dropped;
+            return false;
+        }
+        if (m_pending) {
+            ++m_stats.dropped;
+            // the textures never saw the overwritten frame's changes
+            QBitArray dirtyBands = frame->dirtyBands();
+            yuvMergeBands(dirtyBands, m_pending->dirtyBands());
+            frame->setDirtyBands(dirtyBands);
+        }
+        replaced = std::move(m_pending);
+        m_pending = std::move(frame);
+    }
+    // the replaced frame goes back to its pool outside our lock
+    return true;
+}
+
+bool YuvFramePresenter::hasPending() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_pending.isNull();
+}
+
+bool YuvFramePresenter::take(VideoFrameRef &frame)
+{
+    VideoFrameRef previous;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_pending) {
+            return false;
+        }
+        previous = std::move(frame);
+        frame = std::move(m_pending);
+    }
+    return true;
+}
+
+void YuvFramePresenter::clear()
+{
+    VideoFrameRef pending;
+    {
+        QMutexLocker locker(&m_mutex);
+        pending = std::move(m_pending);
+        m_stats = Stats();
+    }
+}
+
+void YuvFramePresenter::notePresented(qint64 decodeTimestampUs)
+{
+    const qint64 latencyUs = decodeTimestampUs > 0 ? VideoFramePool::clockUs() - decodeTimestampUs : -1;
+    QMutexLocker locker(&m_mutex);
+    ++m_stats.presented;
+    if (latencyUs >= 0) {
+        m_stats.presentLatencyUs += static_cast<quint64>(latencyUs);
+        ++m_stats.latencyFrames;
+    }
+    if (0 == m_stats.firstPresentedMsecs) {
+        QElapsedTimer clock;
+        clock.start();
+        m_stats.firstPresentedMsecs = clock.msecsSinceReference();
+    }
+}
+
+void YuvFramePresenter::noteDropped()
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_stats.dropped;
+}
+
+void YuvFramePresenter::noteUnchanged(qint64 frameBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_stats.received;
+    ++m_stats.unchanged;
+    m_stats.frameBytes += static_cast<quint64>(frameBytes);
+}
+
+void YuvFramePresenter::noteUploaded(qint64 uploadedBytes, qint64 frameBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats.uploadedBytes += static_cast<quint64>(uploadedBytes);
+    m_stats.frameBytes += static_cast<quint64>(frameBytes);
+}
+
+void YuvFramePresenter::noteGpuTime(qint64 elapsedNs, int draws)
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats.gpuNs += static_cast<quint64>(elapsedNs);
+    m_stats.gpuDraws += static_cast<quint64>(draws);
+}
+
+YuvFramePresenter::Stats YuvFramePresenter::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,77 @@
+#ifndef YUVFRAMEPRESENTER_H
+#define YUVFRAMEPRESENTER_H
+
+#include <QMutex>
+#include <QString>
+
+#include "videoframe.h"
+
+// Single-slot "latest frame wins" mailbox between the decoder callback and
+// the display. It only passes pooled frame handles around, pixels are never
+// copied here; whoever presents takes at most one frame per display refresh,
+// everything that was overwritten or superseded before reaching the screen is
+// counted as dropped. An overwritten frame's dirty bands carry over to the
+// frame replacing it, so partial uploads stay complete. All methods are
+// thread-safe.
+class YuvFramePresenter
+{
+public:
+    enum class Policy
+    {
+        // keep the newest frame on screen, may upload frames that are never shown
+        LowLatency = 0,
+        // upload at most once per refresh, adds up to one refresh of latency
+        Smooth,
+    };
+
+    struct Stats
+    {
+        quint64 received = 0;
+        quint64 presented = 0;
+        quint64 dropped = 0;
+        // identical to the previous frame, neither uploaded nor redrawn
+        quint64 unchanged = 0;
+        // full size of the uploaded and unchanged frames, and the bytes actually sent
+        quint64 frameBytes = 0;
+        quint64 uploadedBytes = 0;
+        // GPU time of uploads and draws where timer queries exist, and the draws measured
+        quint64 gpuNs = 0;
+        quint64 gpuDraws = 0;
+        // decode to present time summed over the presented frames that carried a timestamp
+        quint64 presentLatencyUs = 0;
+        quint64 latencyFrames = 0;
+        // QElapsedTimer::msecsSinceReference() of the first presented frame, 0 before it
+        qint64 firstPresentedMsecs = 0;
+    };
+
+    YuvFramePresenter() = default;
+
+    static Policy policyFromString(const QString &policy);
+    static const char *policyName(Policy policy);
+
+    void setPolicy(Policy policy);
+    Policy policy() const;
+
+    // A null frame (pool exhausted, bad planes) is counted as received and dropped.
+    bool submit(VideoFrameRef frame);
+    bool hasPending() const;
+    // Moves the newest frame out, the previous content of frame is released.
+    bool take(VideoFrameRef &frame);
+    void clear();
+
+    // decodeTimestampUs is the frame's VideoFrame::decodeTimestampUs(), 0 when unknown
+    void notePresented(qint64 decodeTimestampUs = 0);
+    void noteDropped();
+    void noteUnchanged(qint64 frameBytes);
+    void noteUploaded(qint64 uploadedBytes, qint64 frameBytes);
+    void noteGpuTime(qint64 elapsedNs, int draws);
+    Stats stats() const;
+
+private:
+    mutable QMutex m_mutex;
+    Policy m_policy = Policy::Smooth;
+    VideoFrameRef m_pending;
+    Stats m_stats;
+};
+
+#endif // YUVFRAMEPRESENTER_H
@@ -0,0 +1,877 @@
+﻿#include <QCoreApplication>
+#include <QDebug>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLPaintDevice>
+#include <QOpenGLTexture>
+#include <QPainter>
+#include <QSurfaceFormat>
+#include <QMatrix2x2>
+#include <QVector4D>
+
+#include "yuvdirtybands.h"
+#include "yuvglrenderer.h"
+#include "yuvrenderthread.h"
+#include "yuvrgbconverter.h"
+#include "yuvshadercache.h"
+
+// 瀛樺偍椤剁偣鍧愭爣鍜岀汗鐞嗗潗鏍?
+// 瀛樺湪涓€璧风紦瀛樺湪vbo
+// 浣跨敤glVertexAttribPointer鎸囧畾璁块棶鏂瑰紡鍗冲彲
+static const GLfloat coordinate[] = {
+    // 椤剁偣鍧愭爣锛屽瓨鍌?涓獂yz鍧愭爣
+    // 鍧愭爣鑼冨洿涓篬-1,1],涓績鐐逛负 0,0
+    // 浜岀淮鍥惧儚z濮嬬粓涓?
+    // GL_TRIANGLE_STRIP鐨勭粯鍒舵柟寮忥細
+    // 浣跨敤鍓?涓潗鏍囩粯鍒朵竴涓笁瑙掑舰锛屼娇鐢ㄥ悗涓変釜鍧愭爣缁樺埗涓€涓笁瑙掑舰锛屾濂戒负涓€涓煩褰?
+    // x     y     z
+    -1.0f,
+    -1.0f,
+    0.0f,
+    1.0f,
+    -1.0f,
+    0.0f,
+    -1.0f,
+    1.0f,
+    0.0f,
+    1.0f,
+    1.0f,
+    0.0f,
+
+    // 绾圭悊鍧愭爣锛屽瓨鍌?涓獂y鍧愭爣
+    // 鍧愭爣鑼冨洿涓篬0,1],宸︿笅瑙掍负 0,0
+    0.0f,
+    1.0f,
+    1.0f,
+    1.0f,
+    0.0f,
+    0.0f,
+    1.0f,
+    0.0f
+};
+
+// 椤剁偣鐫€鑹插櫒
+static const QString s_vertShader = R"(
+    attribute vec3 vertexIn;    // xyz椤剁偣鍧愭爣
+    uniform vec4 textureRect;   // part of the frame to sample: xy offset, zw size
+    uniform mat2 vertexRotation; // quarter turns of the quad inside the viewport
+    attribute vec2 textureIn;   // xy绾圭悊鍧愭爣
+    varying vec2 textureOut;    // 浼犻€掔粰鐗囨鐫€鑹插櫒鐨勭汗鐞嗗潗鏍?
+    void main(void)
+    {
+        gl_Position = vec4(vertexRotation * vertexIn.xy, vertexIn.z, 1.0);  // 1.0琛ㄧずvertexIn鏄竴涓《鐐逛綅缃?
+        textureOut = textureRect.xy + textureIn * textureRect.zw; // 绾圭悊鍧愭爣鐩存帴浼犻€掔粰鐗囨鐫€鑹插櫒
+    }
+)";
+
+// 鐗囨鐫€鑹插櫒
+static const QString s_fragShader = R"(
+    varying vec2 textureOut;        // 鐢遍《鐐圭潃鑹插櫒浼犻€掕繃鏉ョ殑绾圭悊鍧愭爣
+    uniform sampler2D textureY;     // uniform 绾圭悊鍗曞厓锛屽埄鐢ㄧ汗鐞嗗崟鍏冨彲浠ヤ娇鐢ㄥ涓汗鐞?
+    uniform sampler2D textureU;     // sampler2D鏄?D閲囨牱鍣?
+    uniform sampler2D textureV;     // 澹版槑yuv涓変釜绾圭悊鍗曞厓
+    void main(void)
+    {
+        vec3 yuv;
+        vec3 rgb;
+
+        // SDL2 BT709_SHADER_CONSTANTS
+        // https://github.com/spurious/SDL-mirror/blob/4ddd4c445aa059bb127e101b74a8c5b59257fbe2/src/render/opengl/SDL_shaders_gl.c#L102
+        const vec3 Rcoeff = vec3(1.1644,  0.000,  1.7927);
+        const vec3 Gcoeff = vec3(1.1644, -0.2132, -0.5329);
+        const vec3 Bcoeff = vec3(1.1644,  2.1124,  0.000);
+
+        // 鏍规嵁鎸囧畾鐨勭汗鐞唗extureY鍜屽潗鏍噒extureOut鏉ラ噰鏍?
+        yuv.x = texture2D(textureY, textureOut).r;
+        yuv.y = texture2D(textureU, textureOut).r - 0.5;
+        yuv.z = texture2D(textureV, textureOut).r - 0.5;
+
+        // 閲囨牱瀹岃浆涓簉gb
+        // 鍑忓皯涓€浜涗寒搴?
+        yuv.x = yuv.x - 0.0625;
+        rgb.r = dot(yuv, Rcoeff);
+        rgb.g = dot(yuv, Gcoeff);
+        rgb.b = dot(yuv, Bcoeff);
+        // 杈撳嚭棰滆壊鍊?
+        gl_FragColor = vec4(rgb, 1.0);
+    }
+)";
+
+// GLSL 330 core / 300 es variants, the version header is prepended at runtime
+static const QString s_vertShaderModern = R"(
+    in vec3 vertexIn;
+    in vec2 textureIn;
+    out vec2 textureOut;
+    uniform vec4 textureRect;
+    uniform mat2 vertexRotation;
+    void main(void)
+    {
+        gl_Position = vec4(vertexRotation * vertexIn.xy, vertexIn.z, 1.0);
+        textureOut = textureRect.xy + textureIn * textureRect.zw;
+    }
+)";
+
+static const QString s_fragShaderModern = R"(
+    in vec2 textureOut;
+    out vec4 fragColor;
+    uniform sampler2D textureY;
+    uniform sampler2D textureU;     // U plane, or interleaved UV for NV12/P010
+    uniform sampler2D textureV;
+
+    #if defined(YUV_SCALE_BICUBIC)
+    // cubic B-spline weights of the four texels around the sample
+    vec4 cubicWeights(float v)
+    {
+        vec4 n = vec4(1.0, 2.0, 3.0, 4.0) - v;
+        vec4 s = n * n * n;
+        float x = s.x;
+        float y = s.y - 4.0 * s.x;
+        float z = s.z - 4.0 * s.y + 6.0 * s.x;
+        float w = 6.0 - x - y - z;
+        return vec4(x, y, z, w) * (1.0 / 6.0);
+    }
+
+    // 16 texel B-spline from four bilinear taps, on the mip level whose
+    // texels match the window pixels, so shrinking neither aliases nor blurs
+    vec4 sampleScaled(sampler2D tex, vec2 uv)
+    {
+        vec2 baseSize = vec2(textureSize(tex, 0));
+        vec2 footprint = max(abs(dFdx(uv * baseSize)), abs(dFdy(uv * baseSize)));
+        float maxLevel = floor(log2(max(baseSize.x, baseSize.y)));
+        float level = clamp(floor(log2(max(max(footprint.x, footprint.y), 1.0))), 0.0, maxLevel);
+        vec2 size = vec2(textureSize(tex, int(level)));
+
+        vec2 coord = uv * size - 0.5;
+        vec2 f = fract(coord);
+        coord -= f;
+        vec4 xw = cubicWeights(f.x);
+        vec4 yw = cubicWeights(f.y);
+        vec4 c = coord.xxyy + vec2(-0.5, 1.5).xyxy;
+        vec4 s = vec4(xw.xz + xw.yw, yw.xz + yw.yw);
+        vec4 offset = (c + vec4(xw.yw, yw.yw) / s) / size.xxyy;
+
+        vec4 s0 = textureLod(tex, offset.xz, level);
+        vec4 s1 = textureLod(tex, offset.yz, level);
+        vec4 s2 = textureLod(tex, offset.xw, level);
+        vec4 s3 = textureLod(tex, offset.yw, level);
+        float sx = s.x / (s.x + s.y);
+        float sy = s.z / (s.z + s.w);
+        return mix(mix(s3, s2, sx), mix(s1, s0, sx), sy);
+    }
+    #else
+    // bilinear, or trilinear when the textures carry mipmaps
+    vec4 sampleScaled(sampler2D tex, vec2 uv)
+    {
+        return texture(tex, uv);
+    }
+    #endif
+
+    void main(void)
+    {
+        vec3 yuv;
+        vec3 rgb;
+
+        // SDL2 BT709_SHADER_CONSTANTS
+        const vec3 Rcoeff = vec3(1.1644,  0.000,  1.7927);
+        const vec3 Gcoeff = vec3(1.1644, -0.2132, -0.5329);
+        const vec3 Bcoeff = vec3(1.1644,  2.1124,  0.000);
+
+    #if defined(YUV_FORMAT_P010)
+        // 10-bit samples sit in the high bits of 16-bit words, rescale to [0,1]
+        const float p010Scale = 65535.0 / 65472.0;
+        yuv.x = sampleScaled(textureY, textureOut).r * p010Scale;
+        yuv.yz = sampleScaled(textureU, textureOut).rg * p010Scale - 0.5;
+    #elif defined(YUV_FORMAT_NV12)
+        yuv.x = sampleScaled(textureY, textureOut).r;
+        yuv.yz = sampleScaled(textureU, textureOut).rg - 0.5;
+    #else
+        yuv.x = sampleScaled(textureY, textureOut).r;
+        yuv.y = sampleScaled(textureU, textureOut).r - 0.5;
+        yuv.z = sampleScaled(textureV, textureOut).r - 0.5;
+    #endif
+
+        yuv.x = yuv.x - 0.0625;
+        rgb.r = dot(yuv, Rcoeff);
+        rgb.g = dot(yuv, Gcoeff);
+        rgb.b = dot(yuv, Bcoeff);
+        fragColor = vec4(rgb, 1.0);
+    }
+)";
+
+namespace {
+bool s_modernBackendAllowed = true;
+// the default format before requestRenderBackend() upgraded it, the fallback
+QSurfaceFormat s_legacyFormat;
+bool s_legacyFormatSaved = false;
+bool s_renderThreadEnabled = true;
+YuvScaleQuality s_scaleQuality = YuvScaleQuality::Linear;
+
+bool isModernContext(QOpenGLContext *context)
+{
+    const QSurfaceFormat format = context->format();
+    if (context->isOpenGLES()) {
+        return format.majorVersion() >= 3;
+    }
+    return format.version() >= qMakePair(3, 3);
+}
+
+bool hasTextureStorage(QOpenGLContext *context)
+{
+    if (context->isOpenGLES()) {
+        return true;
+    }
+    return context->format().version() >= qMakePair(4, 2) || context->hasExtension(QByteArrayLiteral("GL_ARB_texture_storage"));
+}
+
+bool hasNorm16Textures(QOpenGLContext *context)
+{
+    // R16/RG16 are core on desktop GL 3.0+, ES needs the extension
+    if (context->isOpenGLES()) {
+        return context->hasExtension(QByteArrayLiteral("GL_EXT_texture_norm16"));
+    }
+    return true;
+}
+
+bool probeContext(const QSurfaceFormat &format)
+{
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!surface.isValid() || !context.create() || !context.makeCurrent(&surface)) {
+        return false;
+    }
+    const bool modern = isModernContext(&context);
+    context.doneCurrent();
+    return modern;
+}
+
+QString modernShaderHeader(QOpenGLContext *context)
+{
+    if (context->isOpenGLES()) {
+        return QStringLiteral("#version 300 es\nprecision highp float;\nprecision mediump int;\n");
+    }
+    return QStringLiteral("#version 330 core\n");
+}
+
+const char *scaleQualityDefine(YuvScaleQuality quality)
+{
+    return YuvScaleQuality::Bicubic == quality ? "#define YUV_SCALE_BICUBIC 1\n" : "";
+}
+
+const char *pixelFormatDefine(YuvPixelFormat format)
+{
+    switch (format) {
+    case YuvPixelFormat::NV12:
+        return "#define YUV_FORMAT_NV12 1\n";
+    case YuvPixelFormat::P010:
+        return "#define YUV_FORMAT_P010 1\n";
+    case YuvPixelFormat::I420:
+    default:
+        return "#define YUV_FORMAT_I420 1\n";
+    }
+}
+} // namespace
+
+QMatrix2x2 YuvGLRenderer::rotationMatrix(int quarterTurns)
+{
+    // clockwise on screen is a negative angle in GL's y-up clip space
+    static const float kCos[4] = { 1.0f, 0.0f, -1.0f, 0.0f };
+    static const float kSin[4] = { 0.0f, -1.0f, 0.0f, 1.0f };
+    const int turns = ((quarterTurns % 4) + 4) % 4;
+    const float values[4] = { kCos[turns], -kSin[turns], kSin[turns], kCos[turns] };
+    return QMatrix2x2(values);
+}
+
+void YuvGLRenderer::requestRenderBackend(const QString &backend)
+{
+    const QString value = backend.trimmed().toUpper();
+    if ("SOFTWARE" == value || "GL2" == value || ("AUTO" == value && QCoreApplication::testAttribute(Qt::AA_UseSoftwareOpenGL))) {
+        return;
+    }
+
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    s_legacyFormat = format;
+    s_legacyFormatSaved = true;
+    // openGLModuleType() needs the application, the build and the attribute decide here
+#if defined(QT_OPENGL_ES_2)
+    const bool openGLES = true;
+#else
+    const bool openGLES = QCoreApplication::testAttribute(Qt::AA_UseOpenGLES);
+#endif
+    if (openGLES) {
+        format.setRenderableType(QSurfaceFormat::OpenGLES);
+        format.setVersion(3, 0);
+        format.setProfile(QSurfaceFormat::NoProfile);
+    } else {
+        format.setVersion(3, 3);
+        format.setProfile(QSurfaceFormat::CoreProfile);
+    }
+    QSurfaceFormat::setDefaultFormat(format);
+}
+
+void YuvGLRenderer::setupRenderBackend(const QString &backend)
+{
+    const QString value = backend.trimmed().toUpper();
+    const bool software = "SOFTWARE" == value || ("AUTO" == value && QCoreApplication::testAttribute(Qt::AA_UseSoftwareOpenGL));
+    YuvVideoRenderer::setSoftwareRendering(software);
+    if (software) {
+        qInfo() << "Render backend:" << "Software" << "kernel=" << yuvRgbKernelName(yuvRgbKernel());
+        return;
+    }
+    if ("GL2" == value) {
+        s_modernBackendAllowed = false;
+        qInfo() << "Render backend:" << "GL2 (forced by config)";
+        return;
+    }
+    s_modernBackendAllowed = true;
+
+    // QApplication made the global share context from the format requested
+    // before it, every video context shares with it and must match its profile
+    const QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    QOpenGLContext *shareContext = QOpenGLContext::globalShareContext();
+    const bool modern = shareContext ? (shareContext->isValid() && isModernContext(shareContext)) : probeContext(format);
+    if (!modern) {
+        // the share context is whatever the driver handed out instead, GL2 contexts can join it
+        if (s_legacyFormatSaved) {
+            QSurfaceFormat::setDefaultFormat(s_legacyFormat);
+        }
+        if ("GL3" == value) {
+            qWarning() << "Render backend:" << "GL3 requested but unavailable, falling back to GL2";
+        } else {
+            qInfo() << "Render backend:" << "GL2 (GL3/GLES3 context unavailable)";
+        }
+        return;
+    }
+
+    qInfo() << "Render backend:"
+            << "GL3"
+            << "openGLES=" << (format.renderableType() == QSurfaceFormat::OpenGLES)
+            << "version=" << format.majorVersion() << "." << format.minorVersion();
+}
+
+void YuvGLRenderer::setRenderThreadEnabled(bool enabled)
+{
+    s_renderThreadEnabled = enabled;
+}
+
+void YuvGLRenderer::setScaleQuality(YuvScaleQuality quality)
+{
+    s_scaleQuality = quality;
+}
+
+YuvGLRenderer::YuvGLRenderer() {}
+
+YuvGLRenderer::~YuvGLRenderer()
+{
+    // hosts call destroyRenderer() while their context is still current
+    stopRenderThread();
+}
+
+QSize YuvGLRenderer::framebufferPixelSize() const
+{
+    return m_framebufferPixelSize;
+}
+
+bool YuvGLRenderer::modernBackend(QOpenGLContext *context)
+{
+    return s_modernBackendAllowed && isModernContext(context);
+}
+
+void YuvGLRenderer::shaderSources(QOpenGLContext *context, bool modern, YuvPixelFormat format, YuvScaleQuality quality, QString &vertexSource,
+                                  QString &fragmentSource)
+{
+    if (modern) {
+        const QString header = modernShaderHeader(context);
+        vertexSource = header + s_vertShaderModern;
+        fragmentSource = header + pixelFormatDefine(format) + scaleQualityDefine(quality) + s_fragShaderModern;
+    } else {
+        // the copy keeps s_fragShader unchanged across renderers
+        fragmentSource = s_fragShader;
+        // opengles鐨刦loat銆乮nt绛夎鎵嬪姩鎸囧畾绮惧害
+        if (QCoreApplication::testAttribute(Qt::AA_UseOpenGLES)) {
+            fragmentSource.prepend(R"(
+                                 precision mediump int;
+                                 precision mediump float;
+                                 )");
+        }
+        vertexSource = s_vertShader;
+    }
+}
+
+void YuvGLRenderer::setPixelFormat(YuvPixelFormat format)
+{
+    if (m_pixelFormat == format) {
+        return;
+    }
+
+    // before initializeRenderer the format is only recorded and validated there
+    if (m_glInited && !supportsPixelFormat(format)) {
+        qWarning() << "YUV pixel format unsupported by render backend:" << yuvPixelFormatName(format);
+        return;
+    }
+
+    m_pixelFormat = format;
+    // frames carry their format to the render thread, the shader follows in paintRenderer
+    if (m_renderThread) {
+        return;
+    }
+    // the textures follow with the first frame in the new format
+    m_shaderPixelFormat = format;
+    m_needShaderUpdate = true;
+    requestRedraw();
+}
+
+YuvPixelFormat YuvGLRenderer::pixelFormat() const
+{
+    return m_pixelFormat;
+}
+
+bool YuvGLRenderer::supportsPixelFormat(YuvPixelFormat format) const
+{
+    switch (format) {
+    case YuvPixelFormat::NV12:
+        return m_glInited && m_modernBackend;
+    case YuvPixelFormat::P010:
+        return m_glInited && m_modernBackend && m_norm16Textures;
+    case YuvPixelFormat::I420:
+    default:
+        return true;
+    }
+}
+
+bool YuvGLRenderer::isModernBackend() const
+{
+    return m_modernBackend;
+}
+
+void YuvGLRenderer::frameSubmitted()
+{
+    if (m_renderThread) {
+        m_renderThread->frameSubmitted();
+        return;
+    }
+    // uploaded by paintRenderer, several frames between two refreshes cost one upload
+    requestRedraw();
+}
+
+void YuvGLRenderer::initializeRenderer()
+{
+    initializeOpenGLFunctions();
+    glDisable(GL_DEPTH_TEST);
+
+    // a new context (e.g. after reparenting) has none of the old textures
+    m_texturePool.abandon();
+    m_textureSet = YuvTextures();
+    m_textureInited = false;
+    m_pboUploader.destroy();
+
+    m_modernBackend = modernBackend(glContext());
+    m_textureStorage = m_modernBackend && hasTextureStorage(glContext());
+    m_norm16Textures = m_modernBackend && hasNorm16Textures(glContext());
+    // GL 2.0 / ES 2.0 can not generate mipmaps for non power of two textures
+    m_scaleQuality = m_modernBackend ? s_scaleQuality : YuvScaleQuality::Linear;
+    m_glInited = true;
+    if (!supportsPixelFormat(m_pixelFormat)) {
+        qWarning() << "YUV pixel format unsupported by render backend, using I420:" << yuvPixelFormatName(m_pixelFormat);
+        m_pixelFormat = YuvPixelFormat::I420;
+    }
+    qInfo() << "YUV render backend:"
+            << (m_modernBackend ? "GL3" : "GL2")
+            << "textureStorage=" << m_textureStorage
+            << "norm16=" << m_norm16Textures
+            << "pixelFormat=" << yuvPixelFormatName(m_pixelFormat)
+            << "scaleQuality=" << yuvScaleQualityName(m_scaleQuality);
+    if (m_scaleQuality != s_scaleQuality) {
+        qInfo() << "YUV scale quality needs the GL3 backend, using Linear:" << yuvScaleQualityName(s_scaleQuality);
+    }
+
+    m_texturePool.setup(m_modernBackend, m_textureStorage, YuvScaleQuality::Linear != m_scaleQuality);
+    if (m_modernBackend) {
+        m_gpuTimer.init(glContext());
+    }
+    m_pboSupported = YuvPboUploader::isSupported(glContext());
+    if (!m_pboSupported) {
+        qInfo() << "YUV pixel buffer upload unavailable, using direct texture upload:"
+                << "openGLES=" << glContext()->isOpenGLES()
+                << "version=" << glContext()->format().majorVersion() << "." << glContext()->format().minorVersion();
+    }
+
+    // 椤剁偣缂撳啿瀵硅薄鍒濆鍖?
+    m_vbo.create();
+    m_vbo.bind();
+    m_vbo.allocate(coordinate, sizeof(coordinate));
+    // core profiles have no default vertex array object
+    if (m_modernBackend) {
+        m_vao.create();
+    }
+    m_shaderPixelFormat = m_pixelFormat;
+    initShader();
+    m_needShaderUpdate = false;
+    // 璁剧疆鑳屾櫙娓呯悊鑹蹭负榛戣壊
+    glClearColor(0.0, 0.0, 0.0, 1.0);
+    // 娓呯悊棰滆壊鑳屾櫙
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    startRenderThread();
+}
+
+void YuvGLRenderer::paintRenderer()
+{
+    m_gpuTimer.begin();
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    const YuvRenderThread::TextureSet *frontSet = nullptr;
+    if (m_renderThread) {
+        frontSet = m_renderThread->acquireFrontSet(glContext());
+        if (frontSet && frontSet->format != m_shaderPixelFormat) {
+            m_shaderPixelFormat = frontSet->format;
+            m_needShaderUpdate = true;
+        }
+    }
+
+    if (m_needShaderUpdate) {
+        initShader();
+        // no program without a current context or after a failed link, the next paint retries
+        m_needShaderUpdate = !m_shaderProgram;
+    }
+    if (!m_shaderProgram) {
+        if (frontSet) {
+            m_renderThread->releaseFrontSet(glContext());
+        }
+        if (!m_overlay.isEmpty()) {
+            paintOverlay();
+        }
+        m_gpuTimer.end();
+        return;
+    }
+    m_shaderProgram->bind();
+    if (m_vao.isCreated()) {
+        m_vao.bind();
+    }
+    if (m_vertexStateLost) {
+        setupVertexAttributes();
+        m_vertexStateLost = false;
+    }
+
+    if (!m_renderThread) {
+        uploadPresentFrame();
+    }
+
+    const GLuint *textures = m_textureSet.textures;
+    int planeCount = m_textureSet.layout.size();
+    bool texturesReady = m_textureInited;
+    if (m_renderThread) {
+        texturesReady = nullptr != frontSet;
+        if (frontSet) {
+            textures = frontSet->textures;
+            planeCount = frontSet->layout.size();
+        }
+    }
+
+    if (texturesReady && m_streamFrameSize.width() > 0 && m_streamFrameSize.height() > 0) {
+        GLint currentViewport[4] = { 0, 0, 0, 0 };
+        glGetIntegerv(GL_VIEWPORT, currentViewport);
+
+        QSize viewPixelSize;
+        if (currentViewport[2] > 0 && currentViewport[3] > 0) {
+            viewPixelSize = QSize(currentViewport[2], currentViewport[3]);
+            m_framebufferPixelSize = viewPixelSize;
+        } else if (m_framebufferPixelSize.isValid()) {
+            viewPixelSize = m_framebufferPixelSize;
+        } else {
+            const qreal dpr = glDevicePixelRatio();
+            const QSize logicalSize = glLogicalSize();
+            viewPixelSize = QSize(qRound(logicalSize.width() * dpr), qRound(logicalSize.height() * dpr));
+        }
+
+        const int viewW = qMax(1, viewPixelSize.width());
+        const int viewH = qMax(1, viewPixelSize.height());
+        const QSize canvasSize = effectiveCanvasSize();
+        const QRect contentRect = effectiveContentRect();
+
+        int vpX = 0;
+        int vpY = 0;
+        int vpW = viewW;
+        int vpH = viewH;
+
+        if (viewW > 0 && viewH > 0 && canvasSize.width() > 0 && canvasSize.height() > 0) {
+            vpX = qRound(static_cast<double>(contentRect.x()) * viewW / canvasSize.width());
+            vpY = qRound(static_cast<double>(canvasSize.height() - contentRect.y() - contentRect.height()) * viewH / canvasSize.height());
+            vpW = qRound(static_cast<double>(contentRect.width()) * viewW / canvasSize.width());
+            vpH = qRound(static_cast<double>(contentRect.height()) * viewH / canvasSize.height());
+
+            vpX = qBound(0, vpX, qMax(0, viewW - 1));
+            vpY = qBound(0, vpY, qMax(0, viewH - 1));
+            vpW = qBound(1, vpW, qMax(1, viewW - vpX));
+            vpH = qBound(1, vpH, qMax(1, viewH - vpY));
+        }
+
+        glViewport(vpX, vpY, vpW, vpH);
+
+        for (int i = 0; i < planeCount; ++i) {
+            glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + i));
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+        }
+
+        // the program is shared, every draw sets the part it samples and the rotation
+        m_shaderProgram->setUniformValue(m_textureRectLocation, QVector4D(0.0f, 0.0f, 1.0f, 1.0f));
+        m_shaderProgram->setUniformValue(m_vertexRotationLocation, rotationMatrix(m_rotation));
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        if (!m_zoomViews.isEmpty()) {
+            paintZoomViews(viewW, viewH);
+        }
+
+        glViewport(0, 0, qMax(1, viewW), qMax(1, viewH));
+    }
+
+    if (m_vao.isCreated()) {
+        m_vao.release();
+    }
+    m_shaderProgram->release();
+
+    if (frontSet) {
+        m_renderThread->releaseFrontSet(glContext());
+    }
+
+    if (!m_overlay.isEmpty()) {
+        paintOverlay();
+    }
+
+    m_gpuTimer.end();
+    qint64 gpuNs = 0;
+    const int timedDraws = m_gpuTimer.collect(gpuNs);
+    if (timedDraws > 0) {
+        m_presenter.noteGpuTime(gpuNs, timedDraws);
+    }
+}
+
+void YuvGLRenderer::paintOverlay()
+{
+    const QSize logicalSize = glLogicalSize();
+    const qreal dpr = glDevicePixelRatio();
+    const QSize pixelSize = m_framebufferPixelSize.isValid() ? m_framebufferPixelSize
+                                                             : QSize(qRound(logicalSize.width() * dpr), qRound(logicalSize.height() * dpr));
+    // QPainter's GL engine draws into the framebuffer bound for this paint
+    QOpenGLPaintDevice device(pixelSize);
+    device.setDevicePixelRatio(dpr);
+    {
+        QPainter painter(&device);
+        yuvDrawOverlay(painter, logicalSize, m_overlay);
+    }
+    // it leaves attribute arrays 0-2 disabled, which the GL2 path keeps in
+    // the default vertex array state instead of a VAO
+    if (!m_vao.isCreated()) {
+        m_vertexStateLost = true;
+    }
+}
+
+void YuvGLRenderer::paintZoomViews(int viewW, int viewH)
+{
+    // same textures and program as the frame, only the viewport and the sampled part change
+    for (int i = 0; i < m_zoomViews.size(); ++i) {
+        const YuvZoomView &view = m_zoomViews.at(i);
+        const QRectF source = unrotatedRect(view.source.normalized().intersected(QRectF(0.0, 0.0, 1.0, 1.0)));
+        const int x = qRound(view.target.x() * viewW);
+        const int w = qRound(view.target.width() * viewW);
+        const int h = qRound(view.target.height() * viewH);
+        // GL counts rows from the bottom
+        const int y = viewH - qRound(view.target.y() * viewH) - h;
+        if (source.isEmpty() || w <= 0 || h <= 0) {
+            continue;
+        }
+        glViewport(x, y, w, h);
+        m_shaderProgram->setUniformValue(m_textureRectLocation,
+                                         QVector4D(static_cast<float>(source.x()), static_cast<float>(source.y()), static_cast<float>(source.width()),
+                                                   static_cast<float>(source.height())));
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+}
+
+void YuvGLRenderer::resizeRenderer(int width, int height)
+{
+    m_framebufferPixelSize = QSize(width, height);
+    requestRedraw();
+}
+
+void YuvGLRenderer::destroyRenderer()
+{
+    stopRenderThread();
+    m_vbo.destroy();
+    m_vao.destroy();
+    m_gpuTimer.destroy();
+    YuvShaderCache::release(m_shaderProgram);
+    m_shaderProgram = nullptr;
+    deInitTextures();
+}
+
+void YuvGLRenderer::initShader()
+{
+    QString vertexSource;
+    QString fragmentSource;
+    shaderSources(glContext(), m_modernBackend, m_shaderPixelFormat, m_scaleQuality, vertexSource, fragmentSource);
+    // the other windows of the context group share the program
+    QOpenGLShaderProgram *program = YuvShaderCache::acquire(vertexSource, fragmentSource);
+    YuvShaderCache::release(m_shaderProgram);
+    m_shaderProgram = program;
+    if (!m_shaderProgram) {
+        return;
+    }
+    m_shaderProgram->bind();
+    if (m_vao.isCreated()) {
+        m_vao.bind();
+    }
+    setupVertexAttributes();
+
+    // 鍏宠仈鐗囨鐫€鑹插櫒涓殑绾圭悊鍗曞厓鍜宱pengl涓殑绾圭悊鍗曞厓锛坥pengl涓€鑸彁渚?6涓汗鐞嗗崟鍏冿級
+    m_shaderProgram->setUniformValue("textureY", 0);
+    m_shaderProgram->setUniformValue("textureU", 1);
+    m_shaderProgram->setUniformValue("textureV", 2);
+    m_textureRectLocation = m_shaderProgram->uniformLocation("textureRect");
+    m_vertexRotationLocation = m_shaderProgram->uniformLocation("vertexRotation");
+
+    if (m_vao.isCreated()) {
+        m_vao.release();
+    }
+}
+
+void YuvGLRenderer::setupVertexAttributes()
+{
+    m_vbo.bind();
+    // 鎸囧畾椤剁偣鍧愭爣鍦╲bo涓殑璁块棶鏂瑰紡
+    // 鍙傛暟瑙ｉ噴锛氶《鐐瑰潗鏍囧湪shader涓殑鍙傛暟鍚嶇О锛岄《鐐瑰潗鏍囦负float锛岃捣濮嬪亸绉讳负0锛岄《鐐瑰潗鏍囩被鍨嬩负vec3锛屾骞呬负3涓猣loat
+    m_shaderProgram->setAttributeBuffer("vertexIn", GL_FLOAT, 0, 3, 3 * sizeof(float));
+    // 鍚敤椤剁偣灞炴€?
+    m_shaderProgram->enableAttributeArray("vertexIn");
+
+    // 鎸囧畾绾圭悊鍧愭爣鍦╲bo涓殑璁块棶鏂瑰紡
+    // 鍙傛暟瑙ｉ噴锛氱汗鐞嗗潗鏍囧湪shader涓殑鍙傛暟鍚嶇О锛岀汗鐞嗗潗鏍囦负float锛岃捣濮嬪亸绉讳负12涓猣loat锛堣烦杩囧墠闈㈠瓨鍌ㄧ殑12涓《鐐瑰潗鏍囷級锛岀汗鐞嗗潗鏍囩被鍨嬩负vec2锛屾骞呬负2涓猣loat
+    m_shaderProgram->setAttributeBuffer("textureIn", GL_FLOAT, 12 * sizeof(float), 2, 2 * sizeof(float));
+    m_shaderProgram->enableAttributeArray("textureIn");
+}
+
+bool YuvGLRenderer::bindTextures(YuvPixelFormat format, const QSize &frameSize)
+{
+    if (m_textureInited && m_textureSet.format == format && m_textureSet.frameSize == frameSize) {
+        return true;
+    }
+
+    // a rotation finds the other orientation parked, no GL allocation
+    YuvTextures textures;
+    const bool acquired = m_texturePool.acquire(glContext(), format, frameSize, textures);
+    m_texturePool.release(glContext(), m_textureSet);
+    m_textureSet = textures;
+    m_textureInited = acquired;
+    m_texturesStale = true;
+    if (acquired) {
+        initPixelBuffers();
+    }
+    return acquired;
+}
+
+void YuvGLRenderer::uploadPresentFrame()
+{
+    if (!m_presenter.take(m_presentFrame)) {
+        return;
+    }
+
+    // queued before a size or format change, the frame no longer fits
+    if (m_presentFrame->format() != m_pixelFormat || m_presentFrame->frameSize() != m_streamFrameSize
+        || !bindTextures(m_presentFrame->format(), m_presentFrame->frameSize()) || m_presentFrame->planeCount() != m_textureSet.layout.size()) {
+        m_presentFrame.reset();
+        m_texturesStale = true;
+        m_presenter.noteDropped();
+        return;
+    }
+
+    const QBitArray uploadBands = m_texturesStale ? QBitArray() : m_presentFrame->dirtyBands();
+    const quint8 *planes[3];
+    quint32 strides[3];
+    m_presentFrame->planeData(planes, strides);
+
+    bool uploaded = false;
+    if (m_pboUploader.isInited()) {
+        uploaded = m_pboUploader.upload(m_textureSet.textures, planes, strides, uploadBands);
+    }
+    if (!uploaded) {
+        // rows are tightly packed
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        yuvUploadTextures(glContext(), m_textureSet.layout, m_textureSet.textures, planes, strides, uploadBands);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    if (YuvScaleQuality::Linear != m_scaleQuality) {
+        yuvGenerateMipmaps(glContext(), m_textureSet.layout, m_textureSet.textures);
+    }
+    m_texturesStale = false;
+    m_presenter.noteUploaded(yuvBandBytes(m_textureSet.layout, uploadBands), m_presentFrame->byteCount());
+    // the pixels live in the textures now, give the buffers back to the pool
+    const qint64 decodeTimestampUs = m_presentFrame->decodeTimestampUs();
+    m_presentFrame.reset();
+    m_presenter.notePresented(decodeTimestampUs);
+}
+
+void YuvGLRenderer::initPixelBuffers()
+{
+    if (!m_pboSupported) {
+        return;
+    }
+
+    // same byte count after a rotation, the buffers are reused
+    if (m_pboUploader.relayout(m_textureSet.layout)) {
+        return;
+    }
+    if (!m_pboUploader.init(glContext(), m_textureSet.layout)) {
+        m_pboSupported = false;
+    }
+}
+
+void YuvGLRenderer::deInitTextures()
+{
+    if (QOpenGLFunctions::isInitialized(QOpenGLFunctions::d_ptr) && glContext()) {
+        m_texturePool.release(glContext(), m_textureSet);
+        m_texturePool.clear(glContext());
+    }
+
+    m_textureSet = YuvTextures();
+    m_textureInited = false;
+    m_pboUploader.destroy();
+}
+
+void YuvGLRenderer::startRenderThread()
+{
+    if (!s_renderThreadEnabled || m_renderThread) {
+        return;
+    }
+
+    if (!YuvRenderThread::isSupported(glContext())) {
+        qInfo() << "Video render thread unavailable, uploading on GUI thread:"
+                << "threadedOpenGL=" << QOpenGLContext::supportsThreadedOpenGL()
+                << "fence=" << YuvPboUploader::isFenceSupported(glContext());
+        return;
+    }
+
+    m_renderThread = new YuvRenderThread();
+    if (!m_renderThread->startRendering(glContext(), &m_presenter, m_modernBackend, m_textureStorage, YuvScaleQuality::Linear != m_scaleQuality)) {
+        delete m_renderThread;
+        m_renderThread = nullptr;
+        return;
+    }
+
+    // the thread object lives on the GUI thread, so these run there
+    QObject::connect(m_renderThread, &YuvRenderThread::frameUploaded, m_renderThread, [this]() { requestRedraw(); });
+    // textures live in this context's share group, the worker has to go with it
+    QObject::connect(glContext(), &QOpenGLContext::aboutToBeDestroyed, m_renderThread, [this]() { stopRenderThread(); });
+}
+
+void YuvGLRenderer::stopRenderThread()
+{
+    if (!m_renderThread) {
+        return;
+    }
+
+    m_renderThread->stopRendering();
+    delete m_renderThread;
+    m_renderThread = nullptr;
+}
@@ -0,0 +1,127 @@
+#ifndef YUVGLRENDERER_H
+#define YUVGLRENDERER_H
+#include <QGenericMatrix>
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+
+#include "yuvgputimer.h"
+#include "yuvpbouploader.h"
+#include "yuvtexturepool.h"
+#include "yuvvideorenderer.h"
+
+class QOpenGLContext;
+class YuvRenderThread;
+
+// The GL side of the video renderers: shaders, pooled textures, uploads on
+// the GUI thread or a YuvRenderThread and the draw into the content rect.
+// It does not own a surface; QYUVOpenGLWidget (composited by Qt) and
+// QYUVOpenGLWindow (native window, swaps directly) forward their
+// initializeGL/paintGL/resizeGL and call destroyRenderer() with their
+// context current before it goes away.
+class YuvGLRenderer
+    : public YuvVideoRenderer
+    , protected QOpenGLFunctions
+{
+public:
+    virtual ~YuvGLRenderer() override;
+
+    // Requests a GL 3.3 core (or GLES 3.0) default format for "Auto"/"GL3".
+    // Call before QApplication is constructed: with Qt::AA_ShareOpenGLContexts
+    // the global share context is created from the default format right then,
+    // and contexts of another profile can not share with it.
+    static void requestRenderBackend(const QString &backend);
+    // Settles the backend of every renderer created afterwards. "Auto"/"GL3"
+    // keep GL3 when the share context got it and otherwise restore the GL 2.0
+    // default, "GL2" forces the legacy path. "Software" (or "Auto" with
+    // Qt::AA_UseSoftwareOpenGL) skips GL entirely, see
+    // YuvVideoRenderer::softwareRendering().
+    // Call once after QApplication is constructed.
+    static void setupRenderBackend(const QString &backend);
+    // Uploads frames on a per-renderer thread with a shared context when the
+    // driver supports it, otherwise on the GUI thread. Affects renderers
+    // initialized afterwards.
+    static void setRenderThreadEnabled(bool enabled);
+    // Filtering of renderers initialized afterwards. Mipmap and Bicubic need
+    // the GL3/GLES3 backend, GL2 falls back to Linear.
+    static void setScaleQuality(YuvScaleQuality quality);
+    // Whether renderers on this context take the GL3/GLES3 path.
+    static bool modernBackend(QOpenGLContext *context);
+    // vertexRotation uniform for clockwise quarter turns, identity for 0
+    static QMatrix2x2 rotationMatrix(int quarterTurns);
+    // Sources of the YUV program, for other surfaces drawing frames (see
+    // YuvShaderCache). Sampler uniforms textureY/U/V, attributes vertexIn/textureIn,
+    // vec4 textureRect, the sampled part of the frame (0, 0, 1, 1 for all of it),
+    // and mat2 vertexRotation, see rotationMatrix().
+    static void shaderSources(QOpenGLContext *context, bool modern, YuvPixelFormat format, YuvScaleQuality quality, QString &vertexSource,
+                              QString &fragmentSource);
+
+    QSize framebufferPixelSize() const override;
+    void setPixelFormat(YuvPixelFormat format);
+    YuvPixelFormat pixelFormat() const override;
+    // only I420 is known to work before the GL context is initialized
+    bool supportsPixelFormat(YuvPixelFormat format) const;
+    bool isModernBackend() const;
+
+protected:
+    YuvGLRenderer();
+
+    // the host surface's context, logical size and device pixel ratio
+    virtual QOpenGLContext *glContext() const = 0;
+    virtual QSize glLogicalSize() const = 0;
+    virtual qreal glDevicePixelRatio() const = 0;
+
+    void frameSubmitted() override;
+    void initializeRenderer();
+    void paintRenderer();
+    void resizeRenderer(int width, int height);
+    void destroyRenderer();
+
+private:
+    void initShader();
+    void setupVertexAttributes();
+    void paintOverlay();
+    void paintZoomViews(int viewW, int viewH);
+    // makes m_textureSet fit the frames, swapping to pooled textures
+    bool bindTextures(YuvPixelFormat format, const QSize &frameSize);
+    void deInitTextures();
+    void initPixelBuffers();
+    void uploadPresentFrame();
+    void startRenderThread();
+    void stopRenderThread();
+
+private:
+    QSize m_framebufferPixelSize = { -1, -1 };
+    bool m_needShaderUpdate = false;
+    bool m_textureInited = false;
+    bool m_glInited = false;
+    // the overlay painter reset the GL2 vertex attributes
+    bool m_vertexStateLost = false;
+    bool m_modernBackend = false;
+    bool m_textureStorage = false;
+    bool m_norm16Textures = false;
+    YuvScaleQuality m_scaleQuality = YuvScaleQuality::Linear;
+    YuvPixelFormat m_pixelFormat = YuvPixelFormat::I420;
+    YuvPixelFormat m_shaderPixelFormat = YuvPixelFormat::I420;
+
+    QOpenGLBuffer m_vbo;
+    QOpenGLVertexArrayObject m_vao;
+    // shared with the other renderers of the context group, see YuvShaderCache
+    QOpenGLShaderProgram *m_shaderProgram = nullptr;
+    int m_textureRectLocation = -1;
+    int m_vertexRotationLocation = -1;
+    // GUI thread textures, the render thread keeps its own pool
+    YuvTexturePool m_texturePool { 1 };
+    YuvTextures m_textureSet;
+    bool m_pboSupported = false;
+    YuvPboUploader m_pboUploader;
+    // draw (and GUI thread upload) time, reported through m_presenter
+    YuvGpuTimer m_gpuTimer;
+    VideoFrameRef m_presentFrame;
+    // the GUI thread textures missed changes, upload the next frame in full
+    bool m_texturesStale = true;
+    YuvRenderThread *m_renderThread = nullptr;
+};
+
+#endif // YUVGLRENDERER_H
@@ -0,0 +1,116 @@
+#include <QOpenGLContext>
+
+#include "yuvgputimer.h"
+
+// ES 3.0 headers only know the EXT names
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+
+namespace {
+// results are typically ready two frames later
+constexpr int kQueryRingSize = 3;
+} // namespace
+
+bool YuvGpuTimer::isSupported(QOpenGLContext *context)
+{
+    if (!context) {
+        return false;
+    }
+    if (context->isOpenGLES()) {
+        return context->format().majorVersion() >= 3 && context->hasExtension(QByteArrayLiteral("GL_EXT_disjoint_timer_query"));
+    }
+    return context->format().version() >= qMakePair(3, 3) || context->hasExtension(QByteArrayLiteral("GL_ARB_timer_query"));
+}
+
+bool YuvGpuTimer::init(QOpenGLContext *context)
+{
+    destroy();
+    if (!isSupported(context)) {
+        return false;
+    }
+
+    m_functions = context->extraFunctions();
+    m_queries.resize(kQueryRingSize);
+    for (Query &query : m_queries) {
+        m_functions->glGenQueries(1, &query.id);
+    }
+    m_next = 0;
+    return true;
+}
+
+void YuvGpuTimer::destroy()
+{
+    if (m_functions) {
+        if (m_active) {
+            m_functions->glEndQuery(GL_TIME_ELAPSED);
+        }
+        for (Query &query : m_queries) {
+            m_functions->glDeleteQueries(1, &query.id);
+        }
+    }
+
+    m_queries.clear();
+    m_functions = nullptr;
+    m_next = 0;
+    m_active = false;
+}
+
+bool YuvGpuTimer::isInited() const
+{
+    return m_functions && !m_queries.isEmpty();
+}
+
+void YuvGpuTimer::begin()
+{
+    if (!isInited() || m_active || m_queries[m_next].pending) {
+        return;
+    }
+
+    m_functions->glBeginQuery(GL_TIME_ELAPSED, m_queries[m_next].id);
+    m_active = true;
+}
+
+void YuvGpuTimer::end()
+{
+    if (!m_active) {
+        return;
+    }
+
+    m_functions->glEndQuery(GL_TIME_ELAPSED);
+    m_queries[m_next].pending = true;
+    m_next = (m_next + 1) % m_queries.size();
+    m_active = false;
+}
+
+int YuvGpuTimer::collect(qint64 &elapsedNs)
+{
+    if (!isInited()) {
+        return 0;
+    }
+
+    int collected = 0;
+    for (Query &query : m_queries) {
+        if (!query.pending) {
+            continue;
+        }
+        GLuint available = 0;
+        m_functions->glGetQueryObjectuiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            continue;
+        }
+        // 32 bits of nanoseconds are plenty for one frame
+        GLuint result = 0;
+        m_functions->glGetQueryObjectuiv(query.id, GL_QUERY_RESULT, &result);
+        elapsedNs += static_cast<qint64>(result);
+        query.pending = false;
+        ++collected;
+    }
+    return collected;
+}
@@ -0,0 +1,44 @@
+#ifndef YUVGPUTIMER_H
+#define YUVGPUTIMER_H
+
+#include <QOpenGLExtraFunctions>
+#include <QVector>
+
+class QOpenGLContext;
+
+// GPU time of a span of GL commands, from a small ring of GL_TIME_ELAPSED
+// queries that are read back a few frames later, so measuring never stalls
+// the pipeline. A span is skipped when every query is still in flight.
+// Needs desktop GL 3.3 (or GL_ARB_timer_query) or GL_EXT_disjoint_timer_query
+// on ES. All methods except isSupported() expect the owning context to be current.
+class YuvGpuTimer
+{
+public:
+    YuvGpuTimer() = default;
+    ~YuvGpuTimer() = default;
+
+    static bool isSupported(QOpenGLContext *context);
+
+    bool init(QOpenGLContext *context);
+    void destroy();
+    bool isInited() const;
+
+    void begin();
+    void end();
+    // Adds the finished spans, returns how many there were.
+    int collect(qint64 &elapsedNs);
+
+private:
+    struct Query
+    {
+        GLuint id = 0;
+        bool pending = false;
+    };
+
+    QOpenGLExtraFunctions *m_functions = nullptr;
+    QVector<Query> m_queries;
+    int m_next = 0;
+    bool m_active = false;
+};
+
+#endif // YUVGPUTIMER_H
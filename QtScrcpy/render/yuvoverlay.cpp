@@ -0,0 +1,66 @@
+#include <QFont>
+#include <QPainter>
+#include <QSizeF>
+
+#include "yuvoverlay.h"
+
+namespace {
+constexpr qreal kMarkerRadius = 10.0;
+constexpr qreal kTouchRadius = 18.0;
+
+QPointF toSurface(const QPointF &pos, const QSizeF &surfaceSize)
+{
+    return QPointF(pos.x() * surfaceSize.width(), pos.y() * surfaceSize.height());
+}
+} // namespace
+
+bool YuvOverlay::isEmpty() const
+{
+    return 0 == dimColor.alpha() && hudText.isEmpty() && lines.isEmpty() && markers.isEmpty() && touchPoints.isEmpty();
+}
+
+void yuvDrawOverlay(QPainter &painter, const QSizeF &surfaceSize, const YuvOverlay &overlay)
+{
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    if (overlay.dimColor.alpha() > 0) {
+        painter.fillRect(QRectF(QPointF(0.0, 0.0), surfaceSize), overlay.dimColor);
+    }
+
+    for (const YuvOverlay::Line &line : overlay.lines) {
+        painter.setPen(QPen(line.color, line.width, line.dashed ? Qt::DashLine : Qt::SolidLine));
+        painter.drawLine(toSurface(line.from, surfaceSize), toSurface(line.to, surfaceSize));
+    }
+
+    if (!overlay.markers.isEmpty()) {
+        painter.setFont(QFont(QStringLiteral("Microsoft YaHei UI"), 9));
+        for (const YuvOverlay::Marker &marker : overlay.markers) {
+            const QPointF center = toSurface(marker.pos, surfaceSize);
+            painter.setPen(QPen(QColor(20, 20, 20, 220), 2.0));
+            painter.setBrush(marker.color);
+            painter.drawEllipse(center, kMarkerRadius, kMarkerRadius);
+            if (!marker.label.isEmpty()) {
+                painter.setPen(QColor(240, 240, 240));
+                painter.drawText(QRectF(center.x() + 12.0, center.y() - 12.0, 140.0, 24.0), marker.label);
+            }
+        }
+    }
+
+    if (!overlay.touchPoints.isEmpty()) {
+        painter.setPen(QPen(QColor(255, 255, 255, 200), 2.0));
+        painter.setBrush(QColor(255, 255, 255, 90));
+        for (const QPointF &point : overlay.touchPoints) {
+            painter.drawEllipse(toSurface(point, surfaceSize), kTouchRadius, kTouchRadius);
+        }
+    }
+
+    if (!overlay.hudText.isEmpty()) {
+        QFont font;
+        font.setPointSize(15);
+        font.setBold(true);
+        painter.setFont(font);
+        painter.setPen(QColor(0x00, 0xFF, 0x00));
+        painter.drawText(QRectF(QPointF(5.0, 15.0), surfaceSize), Qt::AlignLeft | Qt::AlignTop, overlay.hudText);
+    }
+    painter.restore();
+}
@@ -0,0 +1,49 @@
+#ifndef YUVOVERLAY_H
+#define YUVOVERLAY_H
+#include <QColor>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+class QPainter;
+class QSizeF;
+
+// HUD the video renderers draw right after the frame, in the same paint:
+// stats text, keymap editor markers and touch points. Positions are
+// normalized to the renderer's surface like keymap coordinates, so nothing
+// has to be stacked on top of the video as a widget.
+struct YuvOverlay
+{
+    struct Line
+    {
+        QPointF from;
+        QPointF to;
+        QColor color;
+        qreal width = 1.0;
+        bool dashed = false;
+    };
+
+    struct Marker
+    {
+        QPointF pos;
+        QColor color;
+        QString label;
+    };
+
+    // filled over the whole surface first, nothing when transparent
+    QColor dimColor = QColor(Qt::transparent);
+    // stats in the top left corner
+    QString hudText;
+    QVector<Line> lines;
+    QVector<Marker> markers;
+    QVector<QPointF> touchPoints;
+
+    bool isEmpty() const;
+};
+
+// Draws the overlay over a surface of surfaceSize logical pixels. The GL
+// renderers paint through a QOpenGLPaintDevice, which batches it into a few
+// draw calls on the context the frame was drawn with.
+void yuvDrawOverlay(QPainter &painter, const QSizeF &surfaceSize, const YuvOverlay &overlay);
+
+#endif // YUVOVERLAY_H
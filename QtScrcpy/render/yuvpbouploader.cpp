@@ -0,0 +1,257 @@
+#include <QDebug>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <cstring>
+
+#include "yuvdirtybands.h"
+#include "yuvpbouploader.h"
+
+// ES 2.0 headers do not declare the buffer mapping / sync enums
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_INVALIDATE_BUFFER_BIT
+#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#endif
+#ifndef GL_MAP_UNSYNCHRONIZED_BIT
+#define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_ALREADY_SIGNALED
+#define GL_ALREADY_SIGNALED 0x911A
+#endif
+#ifndef GL_CONDITION_SATISFIED
+#define GL_CONDITION_SATISFIED 0x911C
+#endif
+
+namespace {
+constexpr int kPboRingSize = 3;
+
+void copyPlaneRows(quint8 *dst, const quint8 *src, quint32 stride, const YuvPlaneInfo &plane, int firstRow, int endRow)
+{
+    const int rowBytes = plane.size.width() * plane.bytesPerPixel;
+    dst += static_cast<qptrdiff>(firstRow) * rowBytes;
+    src += static_cast<qptrdiff>(firstRow) * stride;
+    if (static_cast<int>(stride) == rowBytes) {
+        memcpy(dst, src, static_cast<size_t>(rowBytes) * (endRow - firstRow));
+        return;
+    }
+
+    for (int row = firstRow; row < endRow; ++row) {
+        memcpy(dst, src, static_cast<size_t>(rowBytes));
+        dst += rowBytes;
+        src += stride;
+    }
+}
+} // namespace
+
+bool YuvPboUploader::isSupported(QOpenGLContext *context)
+{
+    if (!context) {
+        return false;
+    }
+
+    const QSurfaceFormat format = context->format();
+    if (context->isOpenGLES()) {
+        // ES 2.0 has neither unpack buffers nor glMapBufferRange
+        return format.majorVersion() >= 3;
+    }
+
+    if (format.majorVersion() >= 3) {
+        return true;
+    }
+    return context->hasExtension(QByteArrayLiteral("GL_ARB_pixel_buffer_object"))
+        && context->hasExtension(QByteArrayLiteral("GL_ARB_map_buffer_range"));
+}
+
+bool YuvPboUploader::isFenceSupported(QOpenGLContext *context)
+{
+    if (!context) {
+        return false;
+    }
+
+    const QSurfaceFormat format = context->format();
+    if (context->isOpenGLES()) {
+        return format.majorVersion() >= 3;
+    }
+    return format.version() >= qMakePair(3, 2) || context->hasExtension(QByteArrayLiteral("GL_ARB_sync"));
+}
+
+bool YuvPboUploader::init(QOpenGLContext *context, const QVector<YuvPlaneInfo> &planes)
+{
+    destroy();
+
+    if (!isSupported(context) || planes.isEmpty() || planes.size() > 3) {
+        return false;
+    }
+
+    m_functions = context->extraFunctions();
+    m_hasFence = isFenceSupported(context);
+    m_planes = planes;
+
+    m_bufferSize = 0;
+    for (int i = 0; i < m_planes.size(); ++i) {
+        const YuvPlaneInfo &plane = m_planes[i];
+        m_planeOffsets[i] = m_bufferSize;
+        m_bufferSize += static_cast<qsizetype>(plane.size.width()) * plane.size.height() * plane.bytesPerPixel;
+    }
+
+    m_slots.resize(kPboRingSize);
+    for (Slot &slot : m_slots) {
+        m_functions->glGenBuffers(1, &slot.buffer);
+        m_functions->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+        m_functions->glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(m_bufferSize), nullptr, GL_STREAM_DRAW);
+    }
+    m_functions->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    m_nextSlot = 0;
+
+    qInfo() << "YUV pixel buffer upload enabled:"
+            << "frameSize=" << m_planes[0].size
+            << "planes=" << m_planes.size()
+            << "ringSize=" << kPboRingSize
+            << "fence=" << m_hasFence;
+    return true;
+}
+
+bool YuvPboUploader::relayout(const QVector<YuvPlaneInfo> &planes)
+{
+    if (!isInited() || planes.isEmpty() || planes.size() > 3) {
+        return false;
+    }
+
+    qsizetype offsets[3] = { 0, 0, 0 };
+    qsizetype size = 0;
+    for (int i = 0; i < planes.size(); ++i) {
+        offsets[i] = size;
+        size += static_cast<qsizetype>(planes[i].size.width()) * planes[i].size.height() * planes[i].bytesPerPixel;
+    }
+    if (size > m_bufferSize) {
+        return false;
+    }
+
+    // the buffer size stays, mapping a few unused bytes is cheaper than reallocating
+    m_planes = planes;
+    for (int i = 0; i < 3; ++i) {
+        m_planeOffsets[i] = offsets[i];
+    }
+    return true;
+}
+
+void YuvPboUploader::destroy()
+{
+    if (m_functions) {
+        for (Slot &slot : m_slots) {
+            if (slot.fence) {
+                m_functions->glDeleteSync(slot.fence);
+            }
+            if (slot.buffer) {
+                m_functions->glDeleteBuffers(1, &slot.buffer);
+            }
+        }
+    }
+
+    m_slots.clear();
+    m_planes.clear();
+    m_functions = nullptr;
+    m_nextSlot = 0;
+    m_bufferSize = 0;
+}
+
+bool YuvPboUploader::isInited() const
+{
+    return m_functions && !m_slots.isEmpty();
+}
+
+bool YuvPboUploader::upload(const GLuint textures[3], const quint8 *const planes[3], const quint32 strides[3], const QBitArray &dirtyBands)
+{
+    if (!isInited()) {
+        return false;
+    }
+    for (int i = 0; i < m_planes.size(); ++i) {
+        if (!planes[i]) {
+            return false;
+        }
+    }
+
+    Slot &slot = m_slots[m_nextSlot];
+    m_nextSlot = (m_nextSlot + 1) % m_slots.size();
+
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+    if (slot.fence) {
+        const GLenum waitResult = m_functions->glClientWaitSync(slot.fence, 0, 0);
+        m_functions->glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        // a still pending transfer is left to the driver: invalidating the
+        // range lets it hand out fresh storage instead of stalling here
+        if (waitResult == GL_ALREADY_SIGNALED || waitResult == GL_CONDITION_SATISFIED) {
+            access |= GL_MAP_UNSYNCHRONIZED_BIT;
+        }
+    }
+
+    m_functions->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+    auto mapped = static_cast<quint8 *>(m_functions->glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(m_bufferSize), access));
+    if (!mapped) {
+        m_functions->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    // the buffer keeps the full frame layout, bands land at their own offsets
+    const QVector<QPair<int, int>> runs = yuvBandRuns(dirtyBands, yuvBandCount(m_planes[0].size));
+    for (int i = 0; i < m_planes.size(); ++i) {
+        const int bandRows = yuvPlaneBandRows(i);
+        for (const QPair<int, int> &run : runs) {
+            const int firstRow = qMin(run.first * bandRows, m_planes[i].size.height());
+            const int endRow = qMin(run.second * bandRows, m_planes[i].size.height());
+            if (endRow > firstRow) {
+                copyPlaneRows(mapped + m_planeOffsets[i], planes[i], strides[i], m_planes[i], firstRow, endRow);
+            }
+        }
+    }
+
+    if (!m_functions->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+        // buffer contents were lost (e.g. display mode change), skip this frame
+        m_functions->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    m_functions->glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    m_functions->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < m_planes.size(); ++i) {
+        const YuvPlaneInfo &plane = m_planes[i];
+        const qsizetype rowBytes = static_cast<qsizetype>(plane.size.width()) * plane.bytesPerPixel;
+        const int bandRows = yuvPlaneBandRows(i);
+        m_functions->glBindTexture(GL_TEXTURE_2D, textures[i]);
+        for (const QPair<int, int> &run : runs) {
+            const int firstRow = qMin(run.first * bandRows, plane.size.height());
+            const int endRow = qMin(run.second * bandRows, plane.size.height());
+            if (endRow <= firstRow) {
+                continue;
+            }
+            m_functions->glTexSubImage2D(
+                GL_TEXTURE_2D,
+                0,
+                0,
+                firstRow,
+                plane.size.width(),
+                endRow - firstRow,
+                plane.format,
+                plane.type,
+                reinterpret_cast<const void *>(static_cast<quintptr>(m_planeOffsets[i] + rowBytes * firstRow)));
+        }
+    }
+    m_functions->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (m_hasFence) {
+        slot.fence = m_functions->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    m_functions->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return true;
+}
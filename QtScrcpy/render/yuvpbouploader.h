@@ -0,0 +1,53 @@
+#ifndef YUVPBOUPLOADER_H
+#define YUVPBOUPLOADER_H
+
+#include <QOpenGLExtraFunctions>
+#include <QSize>
+#include <QVector>
+
+#include "yuvformat.h"
+
+class QOpenGLContext;
+
+// Uploads YUV planes through a ring of pixel unpack buffers.
+// The planes of one frame are copied into a single mapped buffer and the
+// texture transfer is queued from that buffer, so the caller never waits
+// for the driver to finish copying client memory.
+// All methods except isSupported() expect the owning context to be current.
+class YuvPboUploader
+{
+public:
+    YuvPboUploader() = default;
+    ~YuvPboUploader() = default;
+
+    static bool isSupported(QOpenGLContext *context);
+    // glFenceSync/glWaitSync availability (ES 3.0, GL 3.2 or GL_ARB_sync)
+    static bool isFenceSupported(QOpenGLContext *context);
+
+    bool init(QOpenGLContext *context, const QVector<YuvPlaneInfo> &planes);
+    // Switches to another layout (e.g. the rotated frame) that fits the
+    // existing buffers, false when it does not or nothing is inited.
+    bool relayout(const QVector<YuvPlaneInfo> &planes);
+    void destroy();
+    bool isInited() const;
+
+    // only the bands set in a non-empty dirtyBands mask are copied and transferred
+    bool upload(const GLuint textures[3], const quint8 *const planes[3], const quint32 strides[3], const QBitArray &dirtyBands = QBitArray());
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        GLsync fence = nullptr;
+    };
+
+    QOpenGLExtraFunctions *m_functions = nullptr;
+    QVector<Slot> m_slots;
+    int m_nextSlot = 0;
+    bool m_hasFence = false;
+    QVector<YuvPlaneInfo> m_planes;
+    qsizetype m_planeOffsets[3] = { 0, 0, 0 };
+    qsizetype m_bufferSize = 0;
+};
+
+#endif // YUVPBOUPLOADER_H
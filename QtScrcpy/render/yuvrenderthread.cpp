@@ -0,0 +1,331 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+
+#include "yuvdirtybands.h"
+#include "yuvrenderthread.h"
+
+// ES 2.0 headers do not declare the sync enums
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_TIMEOUT_IGNORED
+#define GL_TIMEOUT_IGNORED 0xFFFFFFFFFFFFFFFFull
+#endif
+
+YuvRenderThread::YuvRenderThread(QObject *parent) : QThread(parent)
+{
+    setObjectName("YuvRenderThread");
+}
+
+YuvRenderThread::~YuvRenderThread()
+{
+    stopRendering();
+}
+
+bool YuvRenderThread::isSupported(QOpenGLContext *shareContext)
+{
+    // textures are handed between contexts, fences order the access
+    return shareContext && QOpenGLContext::supportsThreadedOpenGL() && YuvPboUploader::isFenceSupported(shareContext);
+}
+
+bool YuvRenderThread::startRendering(QOpenGLContext *shareContext, YuvFramePresenter *presenter, bool modernTextures, bool textureStorage, bool mipmaps)
+{
+    if (m_context || !presenter || !isSupported(shareContext)) {
+        return false;
+    }
+
+    m_presenter = presenter;
+    m_modernTextures = modernTextures;
+    m_textureStorage = textureStorage;
+    m_mipmaps = mipmaps;
+    m_texturePool.setup(modernTextures, textureStorage, mipmaps);
+
+    // the surface has to be created on the GUI thread
+    m_surface = new QOffscreenSurface();
+    m_surface->setFormat(shareContext->format());
+    m_surface->create();
+
+    m_context = new QOpenGLContext();
+    m_context->setFormat(shareContext->format());
+    m_context->setShareContext(shareContext);
+    if (!m_surface->isValid() || !m_context->create()) {
+        qWarning() << "Video render thread context creation failed";
+        stopRendering();
+        return false;
+    }
+    m_context->moveToThread(this);
+
+    m_stopping = false;
+    m_contextCurrent = false;
+    start();
+    m_startedSemaphore.acquire();
+    if (!m_contextCurrent) {
+        qWarning() << "Video render thread could not make its context current";
+        stopRendering();
+        return false;
+    }
+
+    qInfo() << "Video render thread started:"
+            << "policy=" << YuvFramePresenter::policyName(m_presenter->policy())
+            << "textureStorage=" << m_textureStorage
+            << "mipmaps=" << m_mipmaps
+            << "pixelBuffers=" << m_pboSupported
+            << "gpuTimer=" << m_gpuTimer.isInited();
+    return true;
+}
+
+void YuvRenderThread::stopRendering()
+{
+    if (!m_context) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_condition.wakeOne();
+    }
+    wait();
+
+    delete m_context;
+    m_context = nullptr;
+    if (m_surface) {
+        m_surface->destroy();
+        delete m_surface;
+        m_surface = nullptr;
+    }
+
+    // GL names were released by the worker before it exited
+    for (TextureSet &set : m_sets) {
+        set = TextureSet();
+    }
+    m_frontIndex = 0;
+    m_middleIndex = 1;
+    m_backIndex = 2;
+    m_middleFresh = false;
+}
+
+void YuvRenderThread::frameSubmitted()
+{
+    QMutexLocker locker(&m_mutex);
+    m_condition.wakeOne();
+}
+
+bool YuvRenderThread::canUploadLocked() const
+{
+    if (!m_presenter->hasPending()) {
+        return false;
+    }
+    // Smooth: the previous upload has not reached the screen yet, the newest
+    // frame is sampled when the widget picks it up on the next refresh
+    return YuvFramePresenter::Policy::LowLatency == m_presenter->policy() || !m_middleFresh;
+}
+
+const YuvRenderThread::TextureSet *YuvRenderThread::acquireFrontSet(QOpenGLContext *context)
+{
+    if (!m_context) {
+        return nullptr;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_middleFresh) {
+            std::swap(m_frontIndex, m_middleIndex);
+            m_middleFresh = false;
+            m_presenter->notePresented(m_sets[m_frontIndex].decodeTimestampUs);
+            // the hand-off slot is free again, let the worker sample the mailbox
+            m_condition.wakeOne();
+        }
+    }
+
+    TextureSet &front = m_sets[m_frontIndex];
+    if (!front.textures[0]) {
+        return nullptr;
+    }
+
+    if (front.uploadFence) {
+        QOpenGLExtraFunctions *functions = context->extraFunctions();
+        functions->glWaitSync(front.uploadFence, 0, GL_TIMEOUT_IGNORED);
+        functions->glDeleteSync(front.uploadFence);
+        front.uploadFence = nullptr;
+    }
+    return &front;
+}
+
+void YuvRenderThread::releaseFrontSet(QOpenGLContext *context)
+{
+    TextureSet &front = m_sets[m_frontIndex];
+    QOpenGLExtraFunctions *functions = context->extraFunctions();
+    if (front.drawFence) {
+        functions->glDeleteSync(front.drawFence);
+    }
+    front.drawFence = functions->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // the worker waits on this fence from its own context, it must be flushed
+    functions->glFlush();
+}
+
+void YuvRenderThread::run()
+{
+    m_contextCurrent = m_context->makeCurrent(m_surface);
+    if (m_contextCurrent) {
+        m_pboSupported = YuvPboUploader::isSupported(m_context);
+        m_gpuTimer.init(m_context);
+    }
+    m_startedSemaphore.release();
+    if (!m_contextCurrent) {
+        m_context->moveToThread(QCoreApplication::instance()->thread());
+        return;
+    }
+
+    forever {
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_stopping && !canUploadLocked()) {
+                m_condition.wait(&m_mutex);
+            }
+            if (m_stopping) {
+                break;
+            }
+        }
+        if (!m_presenter->take(m_working)) {
+            continue;
+        }
+        uploadFrame(*m_working);
+        // recycle the buffers now instead of when the next frame arrives
+        m_working.reset();
+    }
+
+    m_pboUploader.destroy();
+    m_gpuTimer.destroy();
+    for (TextureSet &set : m_sets) {
+        destroySet(set);
+    }
+    m_texturePool.clear(m_context);
+    m_context->doneCurrent();
+    m_context->moveToThread(QCoreApplication::instance()->thread());
+}
+
+void YuvRenderThread::uploadFrame(const VideoFrame &frame)
+{
+    QOpenGLExtraFunctions *functions = m_context->extraFunctions();
+    TextureSet &back = m_sets[m_backIndex];
+
+    // the widget may still be sampling these textures from its last draw
+    if (back.drawFence) {
+        functions->glWaitSync(back.drawFence, 0, GL_TIMEOUT_IGNORED);
+        functions->glDeleteSync(back.drawFence);
+        back.drawFence = nullptr;
+    }
+    // left over from a set that was replaced before the widget picked it up
+    if (back.uploadFence) {
+        functions->glDeleteSync(back.uploadFence);
+        back.uploadFence = nullptr;
+    }
+
+    if (!back.textures[0] || back.format != frame.format() || back.frameSize != frame.frameSize()) {
+        if (!allocateSet(back, frame)) {
+            // format has no texture layout on this context, and the frame's
+            // changes are lost for every set
+            m_presenter->noteDropped();
+            for (TextureSet &set : m_sets) {
+                set.staleBands.clear();
+            }
+            return;
+        }
+    }
+
+    m_gpuTimer.begin();
+
+    // the set still holds the frame it got three uploads ago
+    QBitArray uploadBands = frame.dirtyBands();
+    yuvMergeBands(uploadBands, back.staleBands);
+
+    const quint8 *planes[3];
+    quint32 strides[3];
+    frame.planeData(planes, strides);
+
+    bool uploaded = false;
+    if (m_pboSupported) {
+        if (!m_pboUploader.isInited() || m_uploaderFormat != back.format || m_uploaderFrameSize != back.frameSize) {
+            // a rotated frame fits the buffers of the previous orientation
+            if (m_pboUploader.relayout(back.layout) || m_pboUploader.init(m_context, back.layout)) {
+                m_uploaderFormat = back.format;
+                m_uploaderFrameSize = back.frameSize;
+            } else {
+                m_pboSupported = false;
+            }
+        }
+        if (m_pboSupported) {
+            uploaded = m_pboUploader.upload(back.textures, planes, strides, uploadBands);
+        }
+    }
+    if (!uploaded) {
+        functions->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        yuvUploadTextures(m_context, back.layout, back.textures, planes, strides, uploadBands);
+        functions->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    if (m_mipmaps) {
+        yuvGenerateMipmaps(m_context, back.layout, back.textures);
+    }
+    m_gpuTimer.end();
+
+    qint64 gpuNs = 0;
+    if (m_gpuTimer.collect(gpuNs) > 0) {
+        m_presenter->noteGpuTime(gpuNs, 0);
+    }
+    m_presenter->noteUploaded(yuvBandBytes(back.layout, uploadBands), frame.byteCount());
+    back.staleBands.fill(false, yuvBandCount(back.frameSize));
+    back.decodeTimestampUs = frame.decodeTimestampUs();
+    for (TextureSet &set : m_sets) {
+        if (&set != &back) {
+            yuvMergeBands(set.staleBands, frame.dirtyBands());
+        }
+    }
+
+    back.uploadFence = functions->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // make the fence visible to the widget's context
+    functions->glFlush();
+
+    bool notify = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        std::swap(m_backIndex, m_middleIndex);
+        notify = !m_middleFresh;
+        if (m_middleFresh) {
+            // replaced an upload the widget never drew (LowLatency only)
+            m_presenter->noteDropped();
+        }
+        m_middleFresh = true;
+    }
+    if (notify) {
+        emit frameUploaded();
+    }
+}
+
+bool YuvRenderThread::allocateSet(TextureSet &set, const VideoFrame &frame)
+{
+    // acquire before releasing, so the outgoing set still counts for its orientation
+    YuvTextures textures;
+    const bool acquired = m_texturePool.acquire(m_context, frame.format(), frame.frameSize(), textures);
+    m_texturePool.release(m_context, set);
+    static_cast<YuvTextures &>(set) = textures;
+    // pooled textures hold an older frame, the first upload is a full one
+    set.staleBands.clear();
+    return acquired;
+}
+
+void YuvRenderThread::destroySet(TextureSet &set)
+{
+    QOpenGLExtraFunctions *functions = m_context->extraFunctions();
+    if (set.uploadFence) {
+        functions->glDeleteSync(set.uploadFence);
+    }
+    if (set.drawFence) {
+        functions->glDeleteSync(set.drawFence);
+    }
+    m_texturePool.release(m_context, set);
+    set = TextureSet();
+}
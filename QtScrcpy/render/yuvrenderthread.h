@@ -0,0 +1,101 @@
+#ifndef YUVRENDERTHREAD_H
+#define YUVRENDERTHREAD_H
+
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "yuvformat.h"
+#include "yuvframepresenter.h"
+#include "yuvgputimer.h"
+#include "yuvpbouploader.h"
+#include "yuvtexturepool.h"
+
+class QOffscreenSurface;
+class QOpenGLContext;
+
+// Uploads frames into textures on a worker thread.
+// The worker owns a context shared with the widget's one and writes into a
+// triple buffered set of textures: the widget draws the front set, the
+// worker fills the back set and the middle one is the hand-off slot.
+// Frames come from the presenter's mailbox, so a busy GUI thread never
+// builds up a backlog, and go back to their pool as soon as they are uploaded. With the Smooth policy the worker waits until the
+// widget has picked up the previous upload, i.e. once per refresh.
+class YuvRenderThread : public QThread
+{
+    Q_OBJECT
+public:
+    struct TextureSet : YuvTextures
+    {
+        GLsync uploadFence = nullptr;
+        GLsync drawFence = nullptr;
+        // bands uploaded into the other sets since this one was written
+        QBitArray staleBands;
+        // of the uploaded frame, reported when the widget picks the set up
+        qint64 decodeTimestampUs = 0;
+    };
+
+    explicit YuvRenderThread(QObject *parent = nullptr);
+    ~YuvRenderThread() override;
+
+    // Requires fence sync on shareContext. GUI thread only.
+    static bool isSupported(QOpenGLContext *shareContext);
+    // mipmaps are regenerated after every upload when requested
+    bool startRendering(QOpenGLContext *shareContext, YuvFramePresenter *presenter, bool modernTextures, bool textureStorage, bool mipmaps);
+    void stopRendering();
+
+    // Wakes the worker after the presenter received a frame, any thread.
+    void frameSubmitted();
+
+    // Newest uploaded set or nullptr, with the widget's context current.
+    // Every non-null acquire must be paired with releaseFrontSet() after drawing.
+    const TextureSet *acquireFrontSet(QOpenGLContext *context);
+    void releaseFrontSet(QOpenGLContext *context);
+
+signals:
+    // emitted once per batch of frames not yet picked up by the widget
+    void frameUploaded();
+
+protected:
+    void run() override;
+
+private:
+    bool canUploadLocked() const;
+    void uploadFrame(const VideoFrame &frame);
+    bool allocateSet(TextureSet &set, const VideoFrame &frame);
+    void destroySet(TextureSet &set);
+
+private:
+    QOpenGLContext *m_context = nullptr;
+    QOffscreenSurface *m_surface = nullptr;
+    QSemaphore m_startedSemaphore;
+    bool m_contextCurrent = false;
+    bool m_modernTextures = false;
+    bool m_textureStorage = false;
+    bool m_mipmaps = false;
+    YuvFramePresenter *m_presenter = nullptr;
+
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    bool m_stopping = false;
+
+    // indices into m_sets, swapped under m_mutex
+    TextureSet m_sets[3];
+    int m_frontIndex = 0;
+    int m_middleIndex = 1;
+    int m_backIndex = 2;
+    bool m_middleFresh = false;
+
+    // worker thread only
+    VideoFrameRef m_working;
+    // three sets per orientation, rotating swaps sets instead of reallocating
+    YuvTexturePool m_texturePool { 3 };
+    YuvPboUploader m_pboUploader;
+    bool m_pboSupported = false;
+    YuvGpuTimer m_gpuTimer;
+    YuvPixelFormat m_uploaderFormat = YuvPixelFormat::I420;
+    QSize m_uploaderFrameSize;
+};
+
+#endif // YUVRENDERTHREAD_H
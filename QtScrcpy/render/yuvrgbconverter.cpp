@@ -0,0 +1,330 @@
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_AMD64) || defined(_M_IX86)
+#define YUV_RGB_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+#if defined(YUV_RGB_X86) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define YUV_RGB_SSE2 1
+#endif
+// AVX2 is compiled per function and only called after the CPUID check
+#if defined(YUV_RGB_SSE2) && (defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__))
+#define YUV_RGB_AVX2 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#define YUV_RGB_TARGET_AVX2
+#else
+#define YUV_RGB_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define YUV_RGB_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "yuvrgbconverter.h"
+
+namespace {
+// BT.709 limited range in Q13, see s_fragShader
+constexpr int kCoeffY = 9539;   // 1.1644
+constexpr int kCoeffRV = 14686; // 1.7927
+constexpr int kCoeffGU = -1747; // -0.2132
+constexpr int kCoeffGV = -4366; // -0.5329
+constexpr int kCoeffBU = 17305; // 2.1124
+constexpr int kShift = 13;
+constexpr int kRound = 1 << (kShift - 1);
+
+using RowConverter = int (*)(const quint8 *y, const quint8 *u, const quint8 *v, quint32 *dst, int width);
+
+inline quint32 clampByte(int value)
+{
+    return static_cast<quint32>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// Converts [x, width), the SIMD kernels leave their remainder to it.
+void convertRowTail(const quint8 *y, const quint8 *u, const quint8 *v, quint32 *dst, int x, int width, int chromaWidth)
+{
+    for (; x < width; ++x) {
+        const int chromaX = qMin(x / 2, chromaWidth - 1);
+        const int luma = (y[x] - 16) * kCoeffY + kRound;
+        const int cu = u[chromaX] - 128;
+        const int cv = v[chromaX] - 128;
+        const quint32 r = clampByte((luma + kCoeffRV * cv) >> kShift);
+        const quint32 g = clampByte((luma + kCoeffGU * cu + kCoeffGV * cv) >> kShift);
+        const quint32 b = clampByte((luma + kCoeffBU * cu) >> kShift);
+        dst[x] = 0xff000000u | (r << 16) | (g << 8) | b;
+    }
+}
+
+int convertRowScalar(const quint8 *, const quint8 *, const quint8 *, quint32 *, int)
+{
+    return 0;
+}
+
+#if defined(YUV_RGB_SSE2)
+inline __m128i pairConstant(int low, int high)
+{
+    return _mm_set1_epi32(static_cast<int>((static_cast<quint32>(static_cast<quint16>(high)) << 16) | static_cast<quint16>(low)));
+}
+
+int convertRowSse2(const quint8 *y, const quint8 *u, const quint8 *v, quint32 *dst, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xff));
+    const __m128i lumaOffset = _mm_set1_epi16(16);
+    const __m128i chromaOffset = _mm_set1_epi16(128);
+    const __m128i round = _mm_set1_epi32(kRound);
+    const __m128i coeffR = pairConstant(kCoeffY, kCoeffRV);
+    const __m128i coeffGY = pairConstant(kCoeffY, kCoeffGU);
+    const __m128i coeffGV = pairConstant(kCoeffGV, 0);
+    const __m128i coeffB = pairConstant(kCoeffY, kCoeffBU);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        qint32 u4 = 0;
+        qint32 v4 = 0;
+        memcpy(&u4, u + x / 2, sizeof(u4));
+        memcpy(&v4, v + x / 2, sizeof(v4));
+        const __m128i uBytes = _mm_cvtsi32_si128(u4);
+        const __m128i vBytes = _mm_cvtsi32_si128(v4);
+
+        const __m128i luma = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(y + x)), zero), lumaOffset);
+        // every chroma sample covers two pixels
+        const __m128i cu = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(uBytes, uBytes), zero), chromaOffset);
+        const __m128i cv = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(vBytes, vBytes), zero), chromaOffset);
+
+        const __m128i lumaVLo = _mm_unpacklo_epi16(luma, cv);
+        const __m128i lumaVHi = _mm_unpackhi_epi16(luma, cv);
+        const __m128i lumaULo = _mm_unpacklo_epi16(luma, cu);
+        const __m128i lumaUHi = _mm_unpackhi_epi16(luma, cu);
+        const __m128i vLo = _mm_unpacklo_epi16(cv, zero);
+        const __m128i vHi = _mm_unpackhi_epi16(cv, zero);
+
+        const __m128i rLo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(lumaVLo, coeffR), round), kShift);
+        const __m128i rHi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(lumaVHi, coeffR), round), kShift);
+        const __m128i gLo = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(lumaULo, coeffGY), _mm_madd_epi16(vLo, coeffGV)), round), kShift);
+        const __m128i gHi = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(lumaUHi, coeffGY), _mm_madd_epi16(vHi, coeffGV)), round), kShift);
+        const __m128i bLo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(lumaULo, coeffB), round), kShift);
+        const __m128i bHi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(lumaUHi, coeffB), round), kShift);
+
+        // saturate to bytes, then interleave as B G R A
+        const __m128i r = _mm_packus_epi16(_mm_packs_epi32(rLo, rHi), zero);
+        const __m128i g = _mm_packus_epi16(_mm_packs_epi32(gLo, gHi), zero);
+        const __m128i b = _mm_packus_epi16(_mm_packs_epi32(bLo, bHi), zero);
+        const __m128i bg = _mm_unpacklo_epi8(b, g);
+        const __m128i ra = _mm_unpacklo_epi8(r, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x + 4), _mm_unpackhi_epi16(bg, ra));
+    }
+    return x;
+}
+#endif
+
+#if defined(YUV_RGB_AVX2)
+YUV_RGB_TARGET_AVX2 inline __m256i pairConstant256(int low, int high)
+{
+    return _mm256_set1_epi32(static_cast<int>((static_cast<quint32>(static_cast<quint16>(high)) << 16) | static_cast<quint16>(low)));
+}
+
+YUV_RGB_TARGET_AVX2 int convertRowAvx2(const quint8 *y, const quint8 *u, const quint8 *v, quint32 *dst, int width)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha = _mm256_set1_epi8(static_cast<char>(0xff));
+    const __m256i lumaOffset = _mm256_set1_epi16(16);
+    const __m256i chromaOffset = _mm256_set1_epi16(128);
+    const __m256i round = _mm256_set1_epi32(kRound);
+    const __m256i coeffR = pairConstant256(kCoeffY, kCoeffRV);
+    const __m256i coeffGY = pairConstant256(kCoeffY, kCoeffGU);
+    const __m256i coeffGV = pairConstant256(kCoeffGV, 0);
+    const __m256i coeffB = pairConstant256(kCoeffY, kCoeffBU);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i uBytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x / 2));
+        const __m128i vBytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x / 2));
+
+        const __m256i luma = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x))), lumaOffset);
+        const __m256i cu = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(uBytes, uBytes)), chromaOffset);
+        const __m256i cv = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(vBytes, vBytes)), chromaOffset);
+
+        // unpack works per 128-bit lane: "Lo" holds pixels 0-3 and 8-11, "Hi" 4-7 and 12-15
+        const __m256i lumaVLo = _mm256_unpacklo_epi16(luma, cv);
+        const __m256i lumaVHi = _mm256_unpackhi_epi16(luma, cv);
+        const __m256i lumaULo = _mm256_unpacklo_epi16(luma, cu);
+        const __m256i lumaUHi = _mm256_unpackhi_epi16(luma, cu);
+        const __m256i vLo = _mm256_unpacklo_epi16(cv, zero);
+        const __m256i vHi = _mm256_unpackhi_epi16(cv, zero);
+
+        const __m256i rLo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(lumaVLo, coeffR), round), kShift);
+        const __m256i rHi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(lumaVHi, coeffR), round), kShift);
+        const __m256i gLo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(lumaULo, coeffGY), _mm256_madd_epi16(vLo, coeffGV)), round), kShift);
+        const __m256i gHi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(lumaUHi, coeffGY), _mm256_madd_epi16(vHi, coeffGV)), round), kShift);
+        const __m256i bLo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(lumaULo, coeffB), round), kShift);
+        const __m256i bHi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(lumaUHi, coeffB), round), kShift);
+
+        // the in-lane packs put the pixels back in order: 0-7 | 8-15
+        const __m256i r = _mm256_packus_epi16(_mm256_packs_epi32(rLo, rHi), zero);
+        const __m256i g = _mm256_packus_epi16(_mm256_packs_epi32(gLo, gHi), zero);
+        const __m256i b = _mm256_packus_epi16(_mm256_packs_epi32(bLo, bHi), zero);
+        const __m256i bg = _mm256_unpacklo_epi8(b, g);
+        const __m256i ra = _mm256_unpacklo_epi8(r, alpha);
+        const __m256i pixelsLo = _mm256_unpacklo_epi16(bg, ra); // 0-3 | 8-11
+        const __m256i pixelsHi = _mm256_unpackhi_epi16(bg, ra); // 4-7 | 12-15
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), _mm256_permute2x128_si256(pixelsLo, pixelsHi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x + 8), _mm256_permute2x128_si256(pixelsLo, pixelsHi, 0x31));
+    }
+    // finish with 8 pixel steps
+    return x + convertRowSse2(y + x, u + x / 2, v + x / 2, dst + x, width - x);
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = { 0, 0, 0, 0 };
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = 0 != (info[2] & (1 << 27));
+    const bool avx = 0 != (info[2] & (1 << 28));
+    // the OS has to save the YMM registers
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return 0 != (info[1] & (1 << 5));
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#if defined(YUV_RGB_NEON)
+inline uint8x8_t narrowChannel(int32x4_t low, int32x4_t high)
+{
+    return vqmovun_s16(vcombine_s16(vrshrn_n_s32(low, kShift), vrshrn_n_s32(high, kShift)));
+}
+
+void convertHalfNeon(int16x8_t luma, int16x8_t cu, int16x8_t cv, quint32 *dst)
+{
+    const int16x4_t lumaLo = vget_low_s16(luma);
+    const int16x4_t lumaHi = vget_high_s16(luma);
+    const int32x4_t yLo = vmull_n_s16(lumaLo, kCoeffY);
+    const int32x4_t yHi = vmull_n_s16(lumaHi, kCoeffY);
+
+    uint8x8x4_t pixels;
+    pixels.val[0] = narrowChannel(vmlal_n_s16(yLo, vget_low_s16(cu), kCoeffBU), vmlal_n_s16(yHi, vget_high_s16(cu), kCoeffBU));
+    pixels.val[1] = narrowChannel(vmlal_n_s16(vmlal_n_s16(yLo, vget_low_s16(cu), kCoeffGU), vget_low_s16(cv), kCoeffGV),
+                                  vmlal_n_s16(vmlal_n_s16(yHi, vget_high_s16(cu), kCoeffGU), vget_high_s16(cv), kCoeffGV));
+    pixels.val[2] = narrowChannel(vmlal_n_s16(yLo, vget_low_s16(cv), kCoeffRV), vmlal_n_s16(yHi, vget_high_s16(cv), kCoeffRV));
+    pixels.val[3] = vdup_n_u8(0xff);
+    vst4_u8(reinterpret_cast<uint8_t *>(dst), pixels);
+}
+
+int convertRowNeon(const quint8 *y, const quint8 *u, const quint8 *v, quint32 *dst, int width)
+{
+    const int16x8_t lumaOffset = vdupq_n_s16(16);
+    const int16x8_t chromaOffset = vdupq_n_s16(128);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16_t lumaBytes = vld1q_u8(y + x);
+        // every chroma sample covers two pixels
+        const uint8x8x2_t uPairs = vzip_u8(vld1_u8(u + x / 2), vld1_u8(u + x / 2));
+        const uint8x8x2_t vPairs = vzip_u8(vld1_u8(v + x / 2), vld1_u8(v + x / 2));
+
+        for (int half = 0; half < 2; ++half) {
+            const uint8x8_t lumaHalf = 0 == half ? vget_low_u8(lumaBytes) : vget_high_u8(lumaBytes);
+            const int16x8_t luma = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(lumaHalf)), lumaOffset);
+            const int16x8_t cu = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(uPairs.val[half])), chromaOffset);
+            const int16x8_t cv = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vPairs.val[half])), chromaOffset);
+            convertHalfNeon(luma, cu, cv, dst + x + half * 8);
+        }
+    }
+    return x;
+}
+#endif
+
+RowConverter rowConverter(YuvRgbKernel kernel)
+{
+    switch (kernel) {
+#if defined(YUV_RGB_AVX2)
+    case YuvRgbKernel::Avx2:
+        return convertRowAvx2;
+#endif
+#if defined(YUV_RGB_SSE2)
+    case YuvRgbKernel::Sse2:
+        return convertRowSse2;
+#endif
+#if defined(YUV_RGB_NEON)
+    case YuvRgbKernel::Neon:
+        return convertRowNeon;
+#endif
+    default:
+        return convertRowScalar;
+    }
+}
+
+YuvRgbKernel detectKernel()
+{
+#if defined(YUV_RGB_AVX2)
+    if (cpuHasAvx2()) {
+        return YuvRgbKernel::Avx2;
+    }
+#endif
+#if defined(YUV_RGB_SSE2)
+    return YuvRgbKernel::Sse2;
+#elif defined(YUV_RGB_NEON)
+    return YuvRgbKernel::Neon;
+#else
+    return YuvRgbKernel::Scalar;
+#endif
+}
+} // namespace
+
+YuvRgbKernel yuvRgbKernel()
+{
+    static const YuvRgbKernel s_kernel = detectKernel();
+    return s_kernel;
+}
+
+const char *yuvRgbKernelName(YuvRgbKernel kernel)
+{
+    switch (kernel) {
+    case YuvRgbKernel::Sse2:
+        return "SSE2";
+    case YuvRgbKernel::Avx2:
+        return "AVX2";
+    case YuvRgbKernel::Neon:
+        return "NEON";
+    case YuvRgbKernel::Scalar:
+    default:
+        return "Scalar";
+    }
+}
+
+void yuvI420ToRgb32(const quint8 *const planes[3], const quint32 strides[3], const QSize &frameSize,
+                    uchar *dst, int dstStride, int firstRow, int endRow)
+{
+    const RowConverter convertRow = rowConverter(yuvRgbKernel());
+    const int width = frameSize.width();
+    const int chromaWidth = qMax(1, width / 2);
+    const int chromaHeight = qMax(1, frameSize.height() / 2);
+    firstRow = qMax(0, firstRow);
+    endRow = qMin(endRow, frameSize.height());
+
+    for (int row = firstRow; row < endRow; ++row) {
+        const int chromaRow = qMin(row / 2, chromaHeight - 1);
+        const quint8 *y = planes[0] + static_cast<qptrdiff>(row) * strides[0];
+        const quint8 *u = planes[1] + static_cast<qptrdiff>(chromaRow) * strides[1];
+        const quint8 *v = planes[2] + static_cast<qptrdiff>(chromaRow) * strides[2];
+        quint32 *out = reinterpret_cast<quint32 *>(dst + static_cast<qptrdiff>(row) * dstStride);
+        // odd widths keep the last pixel for the scalar tail, chroma reads stay in the plane
+        const int converted = convertRow(y, u, v, out, width & ~1);
+        convertRowTail(y, u, v, out, converted, width, chromaWidth);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef YUVRGBCONVERTER_H
+#define YUVRGBCONVERTER_H
+
+#include <QSize>
+#include <QtGlobal>
+
+// CPU conversion of I420 frames for the software renderer. The integer
+// kernels use the BT.709 limited range constants of the GL shaders and write
+// QImage::Format_RGB32 pixels.
+enum class YuvRgbKernel
+{
+    Scalar = 0,
+    Sse2,
+    Avx2,
+    Neon,
+};
+
+// Fastest kernel this CPU runs, detected once.
+YuvRgbKernel yuvRgbKernel();
+const char *yuvRgbKernelName(YuvRgbKernel kernel);
+
+// Converts rows [firstRow, endRow) of a frame with the kernel from yuvRgbKernel().
+void yuvI420ToRgb32(const quint8 *const planes[3], const quint32 strides[3], const QSize &frameSize,
+                    uchar *dst, int dstStride, int firstRow, int endRow);
+
+#endif // YUVRGBCONVERTER_H
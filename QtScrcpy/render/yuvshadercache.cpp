@@ -0,0 +1,199 @@
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QSaveFile>
+#include <QSurfaceFormat>
+#include <QVector>
+
+#include "yuvshadercache.h"
+
+// names of GLES 3.0 / GL 4.1, missing from older desktop headers
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace {
+struct SharedProgram
+{
+    QOpenGLContextGroup *group = nullptr;
+    QByteArray key;
+    QOpenGLShaderProgram *program = nullptr;
+    int refs = 0;
+};
+
+QString s_diskCacheDir;
+QVector<SharedProgram> s_programs;
+
+bool programBinarySupported(QOpenGLContext *context)
+{
+    const QSurfaceFormat format = context->format();
+    if (context->isOpenGLES()) {
+        if (format.majorVersion() < 3) {
+            return false;
+        }
+    } else if (format.version() < qMakePair(4, 1) && !context->hasExtension(QByteArrayLiteral("GL_ARB_get_program_binary"))) {
+        return false;
+    }
+    GLint formats = 0;
+    context->functions()->glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+// a driver update changes one of the strings and starts a fresh cache entry
+QString binaryCachePath(QOpenGLContext *context, const QByteArray &sourceKey)
+{
+    QOpenGLFunctions *functions = context->functions();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray(reinterpret_cast<const char *>(functions->glGetString(GL_VENDOR))));
+    hash.addData(QByteArray(reinterpret_cast<const char *>(functions->glGetString(GL_RENDERER))));
+    hash.addData(QByteArray(reinterpret_cast<const char *>(functions->glGetString(GL_VERSION))));
+    hash.addData(sourceKey);
+    return s_diskCacheDir + "/" + QString::fromLatin1(hash.result().toHex()) + ".bin";
+}
+
+bool loadBinary(QOpenGLContext *context, QOpenGLShaderProgram *program, const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 binaryFormat = 0;
+    QByteArray binary;
+    stream >> binaryFormat >> binary;
+    if (stream.status() != QDataStream::Ok || binary.isEmpty()) {
+        return false;
+    }
+
+    context->extraFunctions()->glProgramBinary(program->programId(), binaryFormat, binary.constData(), static_cast<GLsizei>(binary.size()));
+    // without attached shaders link() only checks the link status of the binary
+    return program->link();
+}
+
+void saveBinary(QOpenGLContext *context, QOpenGLShaderProgram *program, const QString &path)
+{
+    QOpenGLExtraFunctions *functions = context->extraFunctions();
+    GLint length = 0;
+    functions->glGetProgramiv(program->programId(), GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    QByteArray binary(length, Qt::Uninitialized);
+    GLenum binaryFormat = 0;
+    functions->glGetProgramBinary(program->programId(), length, &length, &binaryFormat, binary.data());
+    binary.resize(length);
+
+    QDir().mkpath(s_diskCacheDir);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream << static_cast<quint32>(binaryFormat) << binary;
+    if (!file.commit()) {
+        qWarning() << "YUV shader binary not cached:" << path;
+    }
+}
+
+QOpenGLShaderProgram *buildProgram(QOpenGLContext *context, const QString &vertexSource, const QString &fragmentSource, const QByteArray &key)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool useDisk = !s_diskCacheDir.isEmpty() && programBinarySupported(context);
+    const QString path = useDisk ? binaryCachePath(context, key) : QString();
+    if (useDisk) {
+        QOpenGLShaderProgram *program = new QOpenGLShaderProgram();
+        if (program->create() && loadBinary(context, program, path)) {
+            qInfo() << "YUV shader program loaded:" << "ms=" << timer.elapsed();
+            return program;
+        }
+        // absent or rejected by the driver, rebuilt and rewritten below
+        delete program;
+    }
+
+    QOpenGLShaderProgram *program = new QOpenGLShaderProgram();
+    program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexSource);
+    program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentSource);
+    if (useDisk) {
+        context->extraFunctions()->glProgramParameteri(program->programId(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    if (!program->link()) {
+        qWarning() << "YUV shader link failed:" << program->log();
+        delete program;
+        return nullptr;
+    }
+    if (useDisk) {
+        saveBinary(context, program, path);
+    }
+    qInfo() << "YUV shader program compiled:" << "ms=" << timer.elapsed() << "diskCache=" << useDisk;
+    return program;
+}
+} // namespace
+
+void YuvShaderCache::setDiskCacheDir(const QString &dir)
+{
+    s_diskCacheDir = dir;
+}
+
+QOpenGLShaderProgram *YuvShaderCache::acquire(const QString &vertexSource, const QString &fragmentSource)
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context) {
+        return nullptr;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(vertexSource.toUtf8());
+    hash.addData(QByteArrayLiteral("\n//fragment\n"));
+    hash.addData(fragmentSource.toUtf8());
+    const QByteArray key = hash.result();
+
+    for (SharedProgram &shared : s_programs) {
+        if (shared.group == context->shareGroup() && shared.key == key) {
+            ++shared.refs;
+            return shared.program;
+        }
+    }
+
+    SharedProgram shared;
+    shared.group = context->shareGroup();
+    shared.key = key;
+    shared.program = buildProgram(context, vertexSource, fragmentSource, key);
+    if (!shared.program) {
+        // not cached, the next acquire() builds it again
+        return nullptr;
+    }
+    shared.refs = 1;
+    s_programs.append(shared);
+    return shared.program;
+}
+
+void YuvShaderCache::release(QOpenGLShaderProgram *program)
+{
+    if (!program) {
+        return;
+    }
+    for (int i = 0; i < s_programs.size(); ++i) {
+        if (s_programs[i].program != program) {
+            continue;
+        }
+        if (--s_programs[i].refs == 0) {
+            delete program;
+            s_programs.remove(i);
+        }
+        return;
+    }
+}
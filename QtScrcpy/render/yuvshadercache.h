@@ -0,0 +1,29 @@
+#ifndef YUVSHADERCACHE_H
+#define YUVSHADERCACHE_H
+
+#include <QString>
+
+class QOpenGLShaderProgram;
+
+// Linked YUV programs shared by every renderer of a context group, keyed by
+// their sources, so only the first window of a session compiles. When the
+// driver can hand out program binaries (GLES 3.0, GL 4.1 or
+// GL_ARB_get_program_binary) they are also kept on disk, keyed by the GL
+// vendor/renderer/version strings, and later sessions skip compiling too.
+// GUI thread only, acquire() and release() expect a context of the group to
+// be current.
+class YuvShaderCache
+{
+public:
+    // Where program binaries are stored, empty keeps them in memory only.
+    // Call before any renderer initializes.
+    static void setDiskCacheDir(const QString &dir);
+
+    // Program built from the sources for the current context's group. Null
+    // without a current context or when linking failed, its log was printed.
+    static QOpenGLShaderProgram *acquire(const QString &vertexSource, const QString &fragmentSource);
+    // Drops a reference from acquire(), the last one deletes the program.
+    static void release(QOpenGLShaderProgram *program);
+};
+
+#endif // YUVSHADERCACHE_H
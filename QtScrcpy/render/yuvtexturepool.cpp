@@ -0,0 +1,123 @@
+#include <QDebug>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+
+#include "yuvtexturepool.h"
+
+YuvTexturePool::YuvTexturePool(int setsPerSize) : m_setsPerSize(qMax(1, setsPerSize)) {}
+
+void YuvTexturePool::setup(bool modernTextures, bool immutableStorage, bool mipmaps)
+{
+    m_modernTextures = modernTextures;
+    m_immutableStorage = immutableStorage;
+    m_mipmaps = mipmaps;
+}
+
+bool YuvTexturePool::acquire(QOpenGLContext *context, YuvPixelFormat format, const QSize &frameSize, YuvTextures &set)
+{
+    set = YuvTextures();
+
+    bool found = false;
+    for (int i = 0; i < m_parked.size(); ++i) {
+        if (m_parked[i].format == format && m_parked[i].frameSize == frameSize) {
+            set = m_parked.takeAt(i);
+            found = true;
+            break;
+        }
+    }
+    if (!found && !create(context, format, frameSize, set)) {
+        return false;
+    }
+    YuvTextures record = set;
+    m_inUse.append(record);
+
+    // the other orientation of the stream is the next size we will be asked for
+    const QSize transposed = frameSize.transposed();
+    if (transposed != frameSize) {
+        while (countSets(format, transposed) < m_setsPerSize) {
+            YuvTextures spare;
+            if (!create(context, format, transposed, spare)) {
+                break;
+            }
+            m_parked.append(spare);
+        }
+    }
+    trim(context);
+    return true;
+}
+
+void YuvTexturePool::release(QOpenGLContext *context, YuvTextures &set)
+{
+    if (!set.textures[0]) {
+        return;
+    }
+
+    for (int i = 0; i < m_inUse.size(); ++i) {
+        if (m_inUse[i].textures[0] == set.textures[0]) {
+            m_inUse.removeAt(i);
+            break;
+        }
+    }
+    m_parked.append(set);
+    set = YuvTextures();
+    trim(context);
+}
+
+void YuvTexturePool::clear(QOpenGLContext *context)
+{
+    QOpenGLFunctions *functions = context->functions();
+    for (YuvTextures &set : m_parked) {
+        functions->glDeleteTextures(3, set.textures);
+    }
+    m_parked.clear();
+}
+
+void YuvTexturePool::abandon()
+{
+    m_parked.clear();
+    m_inUse.clear();
+}
+
+bool YuvTexturePool::create(QOpenGLContext *context, YuvPixelFormat format, const QSize &frameSize, YuvTextures &set)
+{
+    set.layout = yuvPlaneLayout(format, frameSize, m_modernTextures);
+    if (set.layout.isEmpty()) {
+        set = YuvTextures();
+        return false;
+    }
+    set.format = format;
+    set.frameSize = frameSize;
+    yuvCreateTextures(context, set.layout, m_immutableStorage, set.textures, m_mipmaps);
+    qInfo() << "YUV textures created:"
+            << "pixelFormat=" << yuvPixelFormatName(format)
+            << "frameSize=" << frameSize
+            << "parked=" << m_parked.size();
+    return true;
+}
+
+int YuvTexturePool::countSets(YuvPixelFormat format, const QSize &frameSize) const
+{
+    int count = 0;
+    for (const YuvTextures &set : m_parked) {
+        count += (set.format == format && set.frameSize == frameSize) ? 1 : 0;
+    }
+    for (const YuvTextures &set : m_inUse) {
+        count += (set.format == format && set.frameSize == frameSize) ? 1 : 0;
+    }
+    return count;
+}
+
+void YuvTexturePool::trim(QOpenGLContext *context)
+{
+    // one orientation in use, the other one parked
+    const int capacity = 2 * m_setsPerSize;
+    if (m_parked.size() <= capacity) {
+        return;
+    }
+
+    QOpenGLFunctions *functions = context->functions();
+    while (m_parked.size() > capacity) {
+        functions->glDeleteTextures(3, m_parked.first().textures);
+        m_parked.removeFirst();
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef YUVTEXTUREPOOL_H
+#define YUVTEXTUREPOOL_H
+
+#include <QSize>
+#include <QVector>
+
+#include "yuvformat.h"
+
+class QOpenGLContext;
+
+// One frame's worth of plane textures.
+struct YuvTextures
+{
+    GLuint textures[3] = { 0, 0, 0 };
+    QVector<YuvPlaneInfo> layout;
+    YuvPixelFormat format = YuvPixelFormat::I420;
+    QSize frameSize;
+};
+
+// Texture sets of one context kept around for reuse, keyed by format and
+// frame size. Released sets are parked instead of deleted, and every acquire
+// makes sure the transposed size is parked as well, so a rotation swaps to
+// existing textures instead of allocating (immutable storage can not be
+// resized anyway). Parked sets beyond the capacity are deleted oldest first.
+// Parked textures keep whatever they held: upload the next frame in full.
+// All methods expect the owning context to be current.
+class YuvTexturePool
+{
+public:
+    // sets per size that are needed at the same time, and the parked limit
+    explicit YuvTexturePool(int setsPerSize = 1);
+
+    void setup(bool modernTextures, bool immutableStorage, bool mipmaps);
+    // Textures for the format and size, parked ones first. Returns false
+    // (and an empty set) when the format has no layout on this context.
+    bool acquire(QOpenGLContext *context, YuvPixelFormat format, const QSize &frameSize, YuvTextures &set);
+    // Parks the set for reuse, set is emptied. Empty sets are ignored.
+    void release(QOpenGLContext *context, YuvTextures &set);
+    // Deletes the parked sets, release the ones in use first.
+    void clear(QOpenGLContext *context);
+    // Forgets every set without deleting, after their context is gone.
+    void abandon();
+
+private:
+    bool create(QOpenGLContext *context, YuvPixelFormat format, const QSize &frameSize, YuvTextures &set);
+    int countSets(YuvPixelFormat format, const QSize &frameSize) const;
+    void trim(QOpenGLContext *context);
+
+private:
+    int m_setsPerSize = 1;
+    bool m_modernTextures = false;
+    bool m_immutableStorage = false;
+    bool m_mipmaps = false;
+    QVector<YuvTextures> m_parked;
+    // handed out and not released yet, per format and size
+    QVector<YuvTextures> m_inUse;
+};
+
+#endif // YUVTEXTUREPOOL_H
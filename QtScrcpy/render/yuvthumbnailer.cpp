@@ -0,0 +1,125 @@
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YUV_THUMB_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define YUV_THUMB_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "yuvrgbconverter.h"
+#include "yuvthumbnailer.h"
+
+namespace {
+// 256 rows of 255 still fit the 16 bit column sums
+constexpr int kMaxFactor = 256;
+
+// Adds one source row to the column sums.
+void accumulateRow(const quint8 *src, quint16 *sums, int width)
+{
+    int x = 0;
+#if defined(YUV_THUMB_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= width; x += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+        __m128i *low = reinterpret_cast<__m128i *>(sums + x);
+        __m128i *high = reinterpret_cast<__m128i *>(sums + x + 8);
+        _mm_storeu_si128(low, _mm_add_epi16(_mm_loadu_si128(low), _mm_unpacklo_epi8(bytes, zero)));
+        _mm_storeu_si128(high, _mm_add_epi16(_mm_loadu_si128(high), _mm_unpackhi_epi8(bytes, zero)));
+    }
+#elif defined(YUV_THUMB_NEON)
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16_t bytes = vld1q_u8(src + x);
+        vst1q_u16(sums + x, vaddw_u8(vld1q_u16(sums + x), vget_low_u8(bytes)));
+        vst1q_u16(sums + x + 8, vaddw_u8(vld1q_u16(sums + x + 8), vget_high_u8(bytes)));
+    }
+#endif
+    for (; x < width; ++x) {
+        sums[x] = static_cast<quint16>(sums[x] + src[x]);
+    }
+}
+} // namespace
+
+YuvThumbnailer::YuvThumbnailer(int maxSide, int intervalMs)
+    : m_maxSide(qMax(8, maxSide))
+    , m_intervalMs(qMax(0, intervalMs))
+{
+}
+
+bool YuvThumbnailer::update(const quint8 *const planes[3], const quint32 strides[3], const QSize &frameSize)
+{
+    if (!frameSize.isValid() || frameSize.isEmpty()) {
+        return false;
+    }
+    if (m_timer.isValid() && m_timer.elapsed() < m_intervalMs) {
+        return false;
+    }
+    m_timer.start();
+
+    const int longSide = qMax(frameSize.width(), frameSize.height());
+    const int factor = qBound(1, (longSide + m_maxSide - 1) / m_maxSide, kMaxFactor);
+    // even sizes give every 2x2 block of the thumbnail one chroma sample
+    const QSize lumaSize(qMax(2, (frameSize.width() / factor) & ~1), qMax(2, (frameSize.height() / factor) & ~1));
+    const QSize chromaSize(lumaSize.width() / 2, lumaSize.height() / 2);
+    const QSize sourceChromaSize((frameSize.width() + 1) / 2, (frameSize.height() + 1) / 2);
+
+    m_columnSums.resize(frameSize.width());
+    m_planes[0].resize(lumaSize.width() * lumaSize.height());
+    m_planes[1].resize(chromaSize.width() * chromaSize.height());
+    m_planes[2].resize(chromaSize.width() * chromaSize.height());
+    reducePlane(planes[0], strides[0], frameSize, factor, m_planes[0].data(), lumaSize);
+    reducePlane(planes[1], strides[1], sourceChromaSize, factor, m_planes[1].data(), chromaSize);
+    reducePlane(planes[2], strides[2], sourceChromaSize, factor, m_planes[2].data(), chromaSize);
+
+    m_current ^= 1;
+    QImage &image = m_images[m_current];
+    if (image.size() != lumaSize) {
+        image = QImage(lumaSize, QImage::Format_RGB32);
+    }
+    const quint8 *const reduced[3] = { m_planes[0].constData(), m_planes[1].constData(), m_planes[2].constData() };
+    const quint32 reducedStrides[3] = { static_cast<quint32>(lumaSize.width()), static_cast<quint32>(chromaSize.width()),
+                                        static_cast<quint32>(chromaSize.width()) };
+    yuvI420ToRgb32(reduced, reducedStrides, lumaSize, image.bits(), image.bytesPerLine(), 0, lumaSize.height());
+    return true;
+}
+
+const QImage &YuvThumbnailer::image() const
+{
+    return m_images[m_current];
+}
+
+void YuvThumbnailer::reset()
+{
+    m_timer.invalidate();
+    m_images[0] = QImage();
+    m_images[1] = QImage();
+}
+
+void YuvThumbnailer::reducePlane(const quint8 *src, quint32 stride, const QSize &srcSize, int factor, quint8 *dst, const QSize &dstSize)
+{
+    // columns past the last whole block are never read
+    const int usedWidth = qMin(srcSize.width(), dstSize.width() * factor);
+    quint16 *sums = m_columnSums.data();
+
+    for (int dy = 0; dy < dstSize.height(); ++dy) {
+        const int firstRow = qMin(dy * factor, srcSize.height() - 1);
+        const int endRow = qMin(firstRow + factor, srcSize.height());
+        std::fill(sums, sums + usedWidth, static_cast<quint16>(0));
+        for (int row = firstRow; row < endRow; ++row) {
+            accumulateRow(src + static_cast<qptrdiff>(row) * stride, sums, usedWidth);
+        }
+
+        quint8 *out = dst + static_cast<qptrdiff>(dy) * dstSize.width();
+        for (int dx = 0; dx < dstSize.width(); ++dx) {
+            const int firstColumn = qMin(dx * factor, usedWidth - 1);
+            const int endColumn = qMin(firstColumn + factor, usedWidth);
+            quint32 sum = 0;
+            for (int column = firstColumn; column < endColumn; ++column) {
+                sum += sums[column];
+            }
+            const quint32 count = static_cast<quint32>((endRow - firstRow) * (endColumn - firstColumn));
+            out[dx] = static_cast<quint8>((sum + count / 2) / count);
+        }
+    }
+}
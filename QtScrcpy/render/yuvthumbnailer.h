@@ -0,0 +1,38 @@
+#ifndef YUVTHUMBNAILER_H
+#define YUVTHUMBNAILER_H
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QSize>
+#include <QVector>
+
+// Small previews of a stream for views that list many devices. The decoded
+// I420 planes are box filtered on the CPU to a few dozen pixels and converted
+// with yuvI420ToRgb32(); every buffer is kept between calls, so once the frame
+// size is stable a thumbnail costs no allocation.
+class YuvThumbnailer
+{
+public:
+    explicit YuvThumbnailer(int maxSide = 64, int intervalMs = 500);
+
+    // Makes a thumbnail when the interval has passed since the last one,
+    // returns false when the frame was skipped.
+    bool update(const quint8 *const planes[3], const quint32 strides[3], const QSize &frameSize);
+    // Two images are written in turn: a copy of the latest one can be held
+    // until the next update() without the thumbnailer detaching it.
+    const QImage &image() const;
+    void reset();
+
+private:
+    void reducePlane(const quint8 *src, quint32 stride, const QSize &srcSize, int factor, quint8 *dst, const QSize &dstSize);
+
+    int m_maxSide = 64;
+    int m_intervalMs = 500;
+    QElapsedTimer m_timer;
+    QVector<quint16> m_columnSums;
+    QVector<quint8> m_planes[3];
+    QImage m_images[2];
+    int m_current = 0;
+};
+
+#endif // YUVTHUMBNAILER_H
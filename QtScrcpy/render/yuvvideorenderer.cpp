@@ -0,0 +1,202 @@
+#include <QWidget>
+#include <utility>
+
+#include "yuvdirtybands.h"
+#include "yuvvideorenderer.h"
+
+namespace {
+YuvFramePresenter::Policy s_presentPolicy = YuvFramePresenter::Policy::Smooth;
+bool s_softwareRendering = false;
+} // namespace
+
+void YuvVideoRenderer::setPresentPolicy(YuvFramePresenter::Policy policy)
+{
+    s_presentPolicy = policy;
+}
+
+void YuvVideoRenderer::setSoftwareRendering(bool enabled)
+{
+    s_softwareRendering = enabled;
+}
+
+bool YuvVideoRenderer::softwareRendering()
+{
+    return s_softwareRendering;
+}
+
+YuvVideoRenderer::YuvVideoRenderer()
+{
+    m_presenter.setPolicy(s_presentPolicy);
+}
+
+YuvVideoRenderer::~YuvVideoRenderer() {}
+
+void YuvVideoRenderer::setStreamFrameSize(const QSize &frameSize)
+{
+    if (m_streamFrameSize == frameSize) {
+        return;
+    }
+
+    m_streamFrameSize = frameSize;
+    requestRedraw();
+}
+
+const QSize &YuvVideoRenderer::frameSize() const
+{
+    return m_streamFrameSize;
+}
+
+void YuvVideoRenderer::setCanvasSize(const QSize &canvasSize)
+{
+    if (m_canvasSize == canvasSize) {
+        return;
+    }
+
+    m_canvasSize = canvasSize;
+    requestRedraw();
+}
+
+const QSize &YuvVideoRenderer::canvasSize() const
+{
+    return m_canvasSize;
+}
+
+void YuvVideoRenderer::setContentRect(const QRect &contentRect)
+{
+    if (m_contentRect == contentRect) {
+        return;
+    }
+
+    m_contentRect = contentRect;
+    requestRedraw();
+}
+
+const QRect &YuvVideoRenderer::contentRect() const
+{
+    return m_contentRect;
+}
+
+void YuvVideoRenderer::setOverlay(const YuvOverlay &overlay)
+{
+    m_overlay = overlay;
+    requestRedraw();
+}
+
+const YuvOverlay &YuvVideoRenderer::overlay() const
+{
+    return m_overlay;
+}
+
+void YuvVideoRenderer::setZoomViews(const QVector<YuvZoomView> &views)
+{
+    if (views.isEmpty() && m_zoomViews.isEmpty()) {
+        return;
+    }
+    m_zoomViews = views;
+    requestRedraw();
+}
+
+const QVector<YuvZoomView> &YuvVideoRenderer::zoomViews() const
+{
+    return m_zoomViews;
+}
+
+void YuvVideoRenderer::setRotation(int quarterTurns)
+{
+    quarterTurns = ((quarterTurns % 4) + 4) % 4;
+    if (m_rotation == quarterTurns) {
+        return;
+    }
+    m_rotation = quarterTurns;
+    requestRedraw();
+}
+
+int YuvVideoRenderer::rotation() const
+{
+    return m_rotation;
+}
+
+QRectF YuvVideoRenderer::unrotatedRect(const QRectF &rect) const
+{
+    switch (m_rotation) {
+    case 1:
+        return QRectF(rect.y(), 1.0 - rect.x() - rect.width(), rect.height(), rect.width());
+    case 2:
+        return QRectF(1.0 - rect.x() - rect.width(), 1.0 - rect.y() - rect.height(), rect.width(), rect.height());
+    case 3:
+        return QRectF(1.0 - rect.y() - rect.height(), rect.x(), rect.height(), rect.width());
+    default:
+        return rect;
+    }
+}
+
+QSize YuvVideoRenderer::effectiveCanvasSize() const
+{
+    if (m_canvasSize.isValid()) {
+        return m_canvasSize;
+    }
+    return m_streamFrameSize;
+}
+
+QRect YuvVideoRenderer::effectiveContentRect() const
+{
+    const QSize canvas = effectiveCanvasSize();
+    if (!canvas.isValid()) {
+        return QRect();
+    }
+
+    const QRect canvasRect(QPoint(0, 0), canvas);
+    if (!m_contentRect.isValid() || m_contentRect.isEmpty()) {
+        return canvasRect;
+    }
+
+    const QRect clipped = m_contentRect.normalized().intersected(canvasRect);
+    if (!clipped.isValid() || clipped.isEmpty()) {
+        return canvasRect;
+    }
+
+    return clipped;
+}
+
+VideoFrameRef YuvVideoRenderer::acquireFrame()
+{
+    return m_framePool.acquire();
+}
+
+void YuvVideoRenderer::presentFrame(VideoFrameRef frame)
+{
+    if (frame) {
+        QBitArray dirtyBands;
+        if (m_lastFrame) {
+            yuvDiffBands(*m_lastFrame, *frame, dirtyBands);
+        }
+        frame->setDirtyBands(dirtyBands);
+        m_lastFrame = frame;
+        if (!frame->hasChanges()) {
+            // static screen: the display already holds these pixels
+            m_presenter.noteUnchanged(frame->byteCount());
+            return;
+        }
+    }
+
+    if (!m_presenter.submit(std::move(frame))) {
+        return;
+    }
+    frameSubmitted();
+}
+
+YuvFramePresenter::Stats YuvVideoRenderer::presentStats() const
+{
+    return m_presenter.stats();
+}
+
+void YuvVideoRenderer::requestRedraw()
+{
+    widget()->update();
+}
+
+void YuvVideoRenderer::frameSubmitted()
+{
+    // drawn by the next paint, several frames between two refreshes cost one conversion
+    requestRedraw();
+}
@@ -0,0 +1,100 @@
+#ifndef YUVVIDEORENDERER_H
+#define YUVVIDEORENDERER_H
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+#include <QVector>
+
+#include "videoframe.h"
+#include "yuvformat.h"
+#include "yuvframepresenter.h"
+#include "yuvoverlay.h"
+
+class QWidget;
+
+// A magnified part of the frame, drawn after it from the same textures:
+// source is normalized to the frame, target to the renderer's surface.
+struct YuvZoomView
+{
+    QRectF source;
+    QRectF target;
+};
+
+// What VideoForm needs from a video widget: stream/canvas geometry, the
+// frame pool and the presenter mailbox. QYUVOpenGLWidget draws with GL,
+// QYUVSoftwareWidget converts on the CPU; widget() is the QWidget to lay out.
+class YuvVideoRenderer
+{
+public:
+    virtual ~YuvVideoRenderer();
+
+    // Pacing policy of renderers created afterwards.
+    static void setPresentPolicy(YuvFramePresenter::Policy policy);
+    // Widgets created afterwards draw without OpenGL, see QYUVOpenGLWidget::setupRenderBackend().
+    static void setSoftwareRendering(bool enabled);
+    static bool softwareRendering();
+
+    virtual QWidget *widget() = 0;
+
+    void setStreamFrameSize(const QSize &frameSize);
+    const QSize &frameSize() const;
+    void setCanvasSize(const QSize &canvasSize);
+    const QSize &canvasSize() const;
+    void setContentRect(const QRect &contentRect);
+    const QRect &contentRect() const;
+    // drawn over the frames in the same paint, see YuvOverlay
+    void setOverlay(const YuvOverlay &overlay);
+    const YuvOverlay &overlay() const;
+    // drawn between the frame and the overlay, see YuvZoomView; sources are
+    // normalized to the frame as shown, after setRotation()
+    void setZoomViews(const QVector<YuvZoomView> &views);
+    const QVector<YuvZoomView> &zoomViews() const;
+    // Clockwise quarter turns applied when drawing. The stream frame size
+    // stays the uploaded one, canvas and content rect are the rotated ones.
+    void setRotation(int quarterTurns);
+    int rotation() const;
+    // device pixels of the surface the frames end up on
+    virtual QSize framebufferPixelSize() const = 0;
+    virtual YuvPixelFormat pixelFormat() const = 0;
+    // Pooled frame for the next decoder callback, null when every frame of the
+    // pool is still referenced. Never blocks, any thread.
+    VideoFrameRef acquireFrame();
+    // Hands the frame to the presenter's mailbox, the upload happens once per
+    // refresh. A null frame is counted as dropped. The frame is compared with
+    // the previous one first: only changed bands get uploaded, and a frame
+    // without changes is neither uploaded nor redrawn. The caller may keep
+    // its own handle, the pixels are shared rather than copied.
+    void presentFrame(VideoFrameRef frame);
+    YuvFramePresenter::Stats presentStats() const;
+
+protected:
+    YuvVideoRenderer();
+
+    // schedules a paint of whatever surface the frames are drawn on, widget() by default
+    virtual void requestRedraw();
+    // a frame is waiting in m_presenter, schedules a redraw by default
+    virtual void frameSubmitted();
+    QSize effectiveCanvasSize() const;
+    QRect effectiveContentRect() const;
+    // a rect normalized to the rotated frame, as the part of the uploaded frame
+    QRectF unrotatedRect(const QRectF &rect) const;
+
+protected:
+    QSize m_streamFrameSize = { -1, -1 };
+    QSize m_canvasSize = { -1, -1 };
+    QRect m_contentRect;
+    YuvOverlay m_overlay;
+    QVector<YuvZoomView> m_zoomViews;
+    int m_rotation = 0;
+    // mailbox, upload in flight, previous frame for the band compare and the
+    // one being filled
+    VideoFramePool m_framePool { 4 };
+    // declared after the pool so the frames they hold are released first
+    YuvFramePresenter m_presenter;
+    VideoFrameRef m_lastFrame;
+
+private:
+    Q_DISABLE_COPY(YuvVideoRenderer)
+};
+
+#endif // YUVVIDEORENDERER_H
@@ -0,0 +1,130 @@
+#include <QtGlobal>
+
+#include "bitratecontroller.h"
+
+namespace {
+// queued frames behind a stall before the second counts as congested
+constexpr quint32 kBurstFramesMin = 3;
+constexpr int kStepDownSeconds = 3;
+constexpr int kStepUpSeconds = 30;
+// the restarted session needs a few seconds before its arrivals mean anything
+constexpr int kHoldSeconds = 10;
+constexpr quint32 kMinFps = 15;
+constexpr quint32 kUnlimitedFpsTop = 60;
+} // namespace
+
+void BitRateController::setBounds(quint32 minBitRate, quint32 maxBitRate, quint32 maxFps)
+{
+    m_maxBitRate = maxBitRate;
+    m_minBitRate = qMin(minBitRate, maxBitRate);
+    m_fpsLimit = maxFps;
+    m_fpsTop = maxFps > 0 ? maxFps : kUnlimitedFpsTop;
+
+    if (0 == m_bitRate) {
+        m_bitRate = m_maxBitRate;
+        m_fps = m_fpsTop;
+    }
+    // the user may have lowered the bounds while the session ran
+    m_bitRate = qBound(m_minBitRate, m_bitRate, m_maxBitRate);
+    m_fps = qBound(qMin(kMinFps, m_fpsTop), m_fps, m_fpsTop);
+}
+
+void BitRateController::setLatencyTarget(int latencyTargetMs)
+{
+    m_latencyTargetMs = qMax(1, latencyTargetMs);
+}
+
+bool BitRateController::addSample(const Sample &sample, QString *reason)
+{
+    if (m_holdSeconds > 0) {
+        --m_holdSeconds;
+        return false;
+    }
+
+    const bool congested = sample.maxGapMs > m_latencyTargetMs && sample.burstFrames >= kBurstFramesMin;
+    if (congested) {
+        ++m_congestedSeconds;
+        m_clearSeconds = 0;
+    } else if (sample.frames > 0) {
+        ++m_clearSeconds;
+        m_congestedSeconds = 0;
+    }
+
+    bool changed = false;
+    if (m_congestedSeconds >= kStepDownSeconds) {
+        changed = stepDown(reason);
+        if (reason && !reason->isEmpty()) {
+            reason->append(QString(" (stall %1ms, burst %2)").arg(sample.maxGapMs).arg(sample.burstFrames));
+        }
+    } else if (m_clearSeconds >= kStepUpSeconds) {
+        changed = stepUp(reason);
+    }
+
+    if (m_congestedSeconds >= kStepDownSeconds || m_clearSeconds >= kStepUpSeconds) {
+        m_congestedSeconds = 0;
+        m_clearSeconds = 0;
+    }
+    if (changed) {
+        m_holdSeconds = kHoldSeconds;
+    }
+    return changed;
+}
+
+bool BitRateController::stepDown(QString *reason)
+{
+    if (m_bitRate > m_minBitRate) {
+        const quint32 bitRate = qMax(m_minBitRate, m_bitRate / 4 * 3);
+        if (reason) {
+            *reason = QString("congested, bitrate %1 -> %2").arg(m_bitRate).arg(bitRate);
+        }
+        m_bitRate = bitRate;
+        return true;
+    }
+    const quint32 minFps = qMin(kMinFps, m_fpsTop);
+    if (m_fps > minFps) {
+        const quint32 fps = qMax(minFps, m_fps / 4 * 3);
+        if (reason) {
+            *reason = QString("congested at the bitrate floor, max fps %1 -> %2").arg(m_fps).arg(fps);
+        }
+        m_fps = fps;
+        return true;
+    }
+    if (reason && !m_floorReported) {
+        *reason = QString("congested at the floor, nothing left to lower");
+    }
+    m_floorReported = true;
+    return false;
+}
+
+bool BitRateController::stepUp(QString *reason)
+{
+    m_floorReported = false;
+    // frame rate first, it was the last thing given up
+    if (m_fps < m_fpsTop) {
+        const quint32 fps = qMin(m_fpsTop, m_fps / 3 * 4 + 1);
+        if (reason) {
+            *reason = QString("clear, max fps %1 -> %2").arg(m_fps).arg(fps);
+        }
+        m_fps = fps;
+        return true;
+    }
+    if (m_bitRate < m_maxBitRate) {
+        const quint32 bitRate = qMin(m_maxBitRate, m_bitRate / 4 * 5);
+        if (reason) {
+            *reason = QString("clear, bitrate %1 -> %2").arg(m_bitRate).arg(bitRate);
+        }
+        m_bitRate = bitRate;
+        return true;
+    }
+    return false;
+}
+
+quint32 BitRateController::bitRate() const
+{
+    return m_bitRate;
+}
+
+quint32 BitRateController::maxFps() const
+{
+    return m_fps >= m_fpsTop ? m_fpsLimit : m_fps;
+}
@@ -0,0 +1,59 @@
+#ifndef BITRATECONTROLLER_H
+#define BITRATECONTROLLER_H
+
+#include <QString>
+
+// Steps the encoder bitrate of one Wi-Fi session, and once the bitrate is at
+// its floor the max fps, from what the client sees of the frame arrivals.
+// Latency itself is not measurable here: a congested link shows up as a stall
+// longer than the latency target followed by a burst of frames that queued
+// behind it. A quiet device sends no frames at all, those seconds count for
+// nothing. Every change costs a session restart, so the controller holds still
+// for a while after each one and only steps up after a long clean stretch.
+class BitRateController
+{
+public:
+    // one second of frame arrivals
+    struct Sample
+    {
+        quint32 frames = 0;
+        qint64 maxGapMs = 0;
+        // frames that arrived right behind the previous one
+        quint32 burstFrames = 0;
+    };
+
+    BitRateController() = default;
+
+    // maxFps 0 is unlimited, the session is never raised above the bounds
+    void setBounds(quint32 minBitRate, quint32 maxBitRate, quint32 maxFps);
+    void setLatencyTarget(int latencyTargetMs);
+
+    // True when bitRate() or maxFps() changed, reason says why for the log.
+    // Congestion at the floor changes nothing, its reason is given once per
+    // stay there and is empty after that.
+    bool addSample(const Sample &sample, QString *reason);
+
+    quint32 bitRate() const;
+    quint32 maxFps() const;
+
+private:
+    bool stepDown(QString *reason);
+    bool stepUp(QString *reason);
+
+    quint32 m_minBitRate = 0;
+    quint32 m_maxBitRate = 0;
+    // the user's max fps and the value stepping starts from when it is unlimited
+    quint32 m_fpsLimit = 0;
+    quint32 m_fpsTop = 0;
+    int m_latencyTargetMs = 150;
+    // 0 until the first setBounds()
+    quint32 m_bitRate = 0;
+    quint32 m_fps = 0;
+    int m_congestedSeconds = 0;
+    int m_clearSeconds = 0;
+    int m_holdSeconds = 0;
+    // the floor was reported, cleared by the next step up
+    bool m_floorReported = false;
+};
+
+#endif // BITRATECONTROLLER_H
@@ -0,0 +1,240 @@
+#include <QCloseEvent>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <utility>
+
+#include "../QtScrcpyCore/include/QtScrcpyCore.h"
+#include "devicewall.h"
+#include "qyuvwallwidget.h"
+
+class DeviceWall::TileObserver : public qsc::DeviceObserver
+{
+public:
+    TileObserver(DeviceWall *wall, const QString &serial) : m_wall(wall), m_serial(serial) {}
+
+    void onFrame(int width, int height, uint8_t *dataY, uint8_t *dataU, uint8_t *dataV, int linesizeY, int linesizeU, int linesizeV) override
+    {
+        m_wall->onTileFrame(m_serial, width, height, dataY, dataU, dataV, linesizeY, linesizeU, linesizeV);
+    }
+
+    void updateFPS(quint32 fps) override
+    {
+        m_wall->onTileFps(m_serial, fps);
+    }
+
+private:
+    DeviceWall *m_wall = nullptr;
+    QString m_serial;
+};
+
+DeviceWall::DeviceWall(QWidget *parent) : QWidget(parent)
+{
+    setWindowTitle(tr("Device wall"));
+    resize(1280, 800);
+
+    m_wall = new QYUVWallWidget(this);
+    m_wall->setMouseTracking(true);
+    m_wall->setFocusPolicy(Qt::StrongFocus);
+    m_wall->setToolTip(tr("Ctrl+click a device to open it in its own window"));
+    m_wall->installEventFilter(this);
+
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_wall);
+}
+
+DeviceWall::~DeviceWall()
+{
+    const QStringList serials = m_observers.keys();
+    for (const QString &serial : serials) {
+        removeDevice(serial);
+    }
+}
+
+void DeviceWall::addDevice(const QString &serial, const QString &name)
+{
+    auto device = qsc::IDeviceManage::getInstance().getDevice(serial);
+    if (!device || m_observers.contains(serial)) {
+        return;
+    }
+
+    m_names.insert(serial, name);
+    m_wall->addTile(serial);
+    m_wall->setTileLabel(serial, name);
+    TileObserver *observer = new TileObserver(this, serial);
+    m_observers.insert(serial, observer);
+    device->registerDeviceObserver(observer);
+}
+
+void DeviceWall::removeDevice(const QString &serial)
+{
+    TileObserver *observer = m_observers.take(serial);
+    if (!observer) {
+        return;
+    }
+
+    auto device = qsc::IDeviceManage::getInstance().getDevice(serial);
+    if (device) {
+        device->deRegisterDeviceObserver(observer);
+    }
+    delete observer;
+    m_names.remove(serial);
+    m_wall->removeTile(serial);
+    if (m_pressedSerial == serial) {
+        m_pressedSerial.clear();
+    }
+    if (m_focusSerial == serial) {
+        m_focusSerial.clear();
+    }
+}
+
+bool DeviceWall::hasDevice(const QString &serial) const
+{
+    return m_observers.contains(serial);
+}
+
+bool DeviceWall::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched != m_wall) {
+        return QWidget::eventFilter(watched, event);
+    }
+
+    switch (event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonDblClick: {
+        QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+        const QString serial = m_wall->tileAt(mouseEvent->pos());
+        if (serial.isEmpty()) {
+            return true;
+        }
+        if (mouseEvent->button() == Qt::LeftButton && (mouseEvent->modifiers() & Qt::ControlModifier)) {
+            emit openDeviceRequested(serial, m_wall->tileFrameSize(serial));
+            return true;
+        }
+        m_pressedSerial = serial;
+        m_focusSerial = serial;
+        sendMouseEvent(serial, mouseEvent);
+        return true;
+    }
+    case QEvent::MouseMove:
+        if (!m_pressedSerial.isEmpty()) {
+            sendMouseEvent(m_pressedSerial, static_cast<QMouseEvent *>(event));
+        }
+        return true;
+    case QEvent::MouseButtonRelease: {
+        QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+        if (!m_pressedSerial.isEmpty()) {
+            sendMouseEvent(m_pressedSerial, mouseEvent);
+            if (Qt::NoButton == mouseEvent->buttons()) {
+                m_pressedSerial.clear();
+            }
+        }
+        return true;
+    }
+    case QEvent::Wheel: {
+        QWheelEvent *wheelEvent = static_cast<QWheelEvent *>(event);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+        const QString serial = m_wall->tileAt(wheelEvent->position().toPoint());
+#else
+        const QString serial = m_wall->tileAt(wheelEvent->pos());
+#endif
+        if (!serial.isEmpty()) {
+            sendWheelEvent(serial, wheelEvent);
+        }
+        return true;
+    }
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease: {
+        auto device = qsc::IDeviceManage::getInstance().getDevice(m_focusSerial);
+        if (!device) {
+            return false;
+        }
+        emit device->keyEvent(static_cast<QKeyEvent *>(event), m_wall->tileFrameSize(m_focusSerial), m_wall->tileVideoRect(m_focusSerial).size());
+        return true;
+    }
+    default:
+        break;
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void DeviceWall::closeEvent(QCloseEvent *event)
+{
+    Q_UNUSED(event)
+    // like closing a VideoForm, the devices on the wall disconnect
+    const QStringList serials = m_observers.keys();
+    for (const QString &serial : serials) {
+        auto device = qsc::IDeviceManage::getInstance().getDevice(serial);
+        if (device) {
+            device->disconnectDevice();
+        }
+    }
+}
+
+void DeviceWall::onTileFrame(const QString &serial, int width, int height, uint8_t *dataY, uint8_t *dataU, uint8_t *dataV, int linesizeY,
+                             int linesizeU, int linesizeV)
+{
+    // the decoder planes are only valid during this call; a tile whose pool
+    // is exhausted keeps showing its previous frame
+    VideoFrameRef frame = m_wall->acquireFrame(serial);
+    if (!frame) {
+        return;
+    }
+    const quint8 *const planes[3] = { dataY, dataU, dataV };
+    const quint32 strides[3] = { static_cast<quint32>(linesizeY), static_cast<quint32>(linesizeU), static_cast<quint32>(linesizeV) };
+    if (!frame->fill(YuvPixelFormat::I420, QSize(width, height), planes, strides)) {
+        return;
+    }
+    m_wall->presentFrame(serial, std::move(frame));
+}
+
+void DeviceWall::onTileFps(const QString &serial, quint32 fps)
+{
+    m_wall->setTileLabel(serial, QString("%1  FPS:%2").arg(m_names.value(serial)).arg(fps));
+}
+
+void DeviceWall::sendMouseEvent(const QString &serial, QMouseEvent *event)
+{
+    auto device = qsc::IDeviceManage::getInstance().getDevice(serial);
+    const QRect videoRect = m_wall->tileVideoRect(serial);
+    if (!device || videoRect.isEmpty()) {
+        return;
+    }
+
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+    QPointF localPos = event->localPos();
+    QPointF globalPos = event->globalPos();
+#else
+    QPointF localPos = event->position();
+    QPointF globalPos = event->globalPosition();
+#endif
+    // tile coordinates, a drag leaving the tile sticks to its edge
+    localPos -= videoRect.topLeft();
+    localPos.setX(qBound(0.0, localPos.x(), static_cast<qreal>(videoRect.width())));
+    localPos.setY(qBound(0.0, localPos.y(), static_cast<qreal>(videoRect.height())));
+    QMouseEvent newEvent(event->type(), localPos, globalPos, event->button(), event->buttons(), event->modifiers());
+    emit device->mouseEvent(&newEvent, m_wall->tileFrameSize(serial), videoRect.size());
+}
+
+void DeviceWall::sendWheelEvent(const QString &serial, QWheelEvent *event)
+{
+    auto device = qsc::IDeviceManage::getInstance().getDevice(serial);
+    const QRect videoRect = m_wall->tileVideoRect(serial);
+    if (!device || videoRect.isEmpty()) {
+        return;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    const QPointF pos = event->position() - videoRect.topLeft();
+    QWheelEvent wheelEvent(
+        pos, event->globalPosition(), event->pixelDelta(), event->angleDelta(), event->buttons(), event->modifiers(), event->phase(), event->inverted());
+#else
+    const QPointF pos = event->posF() - videoRect.topLeft();
+    QWheelEvent wheelEvent(
+        pos, event->globalPosF(), event->pixelDelta(), event->angleDelta(), event->delta(), event->orientation(),
+        event->buttons(), event->modifiers(), event->phase(), event->source(), event->inverted());
+#endif
+    emit device->wheelEvent(&wheelEvent, m_wall->tileFrameSize(serial), videoRect.size());
+}
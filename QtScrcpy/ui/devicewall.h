@@ -0,0 +1,54 @@
+#ifndef DEVICEWALL_H
+#define DEVICEWALL_H
+
+#include <cstdint>
+#include <QHash>
+#include <QWidget>
+
+class QMouseEvent;
+class QWheelEvent;
+class QYUVWallWidget;
+
+// One window for many devices: each connected device is a tile of a single
+// QYUVWallWidget instead of a VideoForm with its own GL context, tool form
+// and timers. Mouse, wheel and key input on a tile reaches the device
+// through qsc::IDevice like in VideoForm; Ctrl+click on a tile asks for the
+// device to get its own VideoForm.
+class DeviceWall : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit DeviceWall(QWidget *parent = nullptr);
+    ~DeviceWall();
+
+    void addDevice(const QString &serial, const QString &name);
+    // stops observing the device and removes its tile
+    void removeDevice(const QString &serial);
+    bool hasDevice(const QString &serial) const;
+
+signals:
+    void openDeviceRequested(const QString &serial, const QSize &frameSize);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void closeEvent(QCloseEvent *event) override;
+
+private:
+    class TileObserver;
+    friend class TileObserver;
+
+    void onTileFrame(const QString &serial, int width, int height, uint8_t *dataY, uint8_t *dataU, uint8_t *dataV, int linesizeY, int linesizeU,
+                     int linesizeV);
+    void onTileFps(const QString &serial, quint32 fps);
+    void sendMouseEvent(const QString &serial, QMouseEvent *event);
+    void sendWheelEvent(const QString &serial, QWheelEvent *event);
+
+    QYUVWallWidget *m_wall = nullptr;
+    QHash<QString, TileObserver *> m_observers;
+    QHash<QString, QString> m_names;
+    // tile holding the mouse grab, and the one keys go to
+    QString m_pressedSerial;
+    QString m_focusSerial;
+};
+
+#endif // DEVICEWALL_H
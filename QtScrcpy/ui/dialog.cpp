@@ -24,6 +24,8 @@
 #include <QVBoxLayout>
 
 #include "config.h"
+#include "devicewall.h"
+#include "encoderprobe.h"
 #include "thememanager.h"
 #include "dialog.h"
 #include "ui_dialog.h"
@@ -63,6 +65,28 @@ QKeySequence normalizeSingleShortcut(const QKeySequence &shortcut)
     return QKeySequence(shortcut[0]);
 #endif
 }
+
+constexpr int kReconnectBaseDelayMs = 500;
+constexpr int kReconnectMaxDelayMs = 8000;
+constexpr int kReconnectMaxAttempts = 10;
+// a codec A/B preset that has not finished sampling by then is given up,
+// warmup and sampling take 11 s plus the restart
+constexpr int kCodecBenchmarkPresetTimeoutMs = 30000;
+// BackgroundThrottle: what a hidden window's session is lowered to, never above the user's values
+constexpr quint32 kBackgroundMaxFps = 5;
+constexpr quint32 kBackgroundBitRate = 1000000;
+
+// VideoForm has no WA_DeleteOnClose, a closed window outlives its QPointer
+bool videoFormOpen(const VideoForm *videoForm)
+{
+    return videoForm && videoForm->isVisible() && !videoForm->closeRequested();
+}
+
+// "ip:port" from adb connect, or an mDNS discovered wireless debugging device
+bool isWifiSerial(const QString &serial)
+{
+    return serial.contains(':') || serial.contains("._adb-tls-connect.");
+}
 }
 
 const QString &getKeyMapPath()
@@ -126,6 +150,9 @@ Dialog::Dialog(QWidget *parent) : QWidget(parent), ui(new Ui::Widget)
                     for (auto &item : devices) {
                         ui->serialBox->addItem(item);
                         ui->connectedPhoneList->addItem(Config::getInstance().getNickName(item) + "-" + item);
+                        if (m_thumbnails.contains(item)) {
+                            ui->connectedPhoneList->item(ui->connectedPhoneList->count() - 1)->setData(Qt::DecorationRole, m_thumbnails.value(item));
+                        }
                     }
 
                     if (!previousSerial.isEmpty()) {
@@ -284,6 +311,9 @@ void Dialog::initUI()
                 this, &Dialog::showIpEditMenu);
     }
     
+    // 投屏中的设备在列表中显示实时缩略图
+    ui->connectedPhoneList->setIconSize(QSize(64, 64));
+
     // 为devicePortEdt添加右键菜单
     if (ui->devicePortEdt->lineEdit()) {
         ui->devicePortEdt->lineEdit()->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -320,6 +350,8 @@ void Dialog::initUI()
 
     connect(ui->serialBox, &QComboBox::currentTextChanged,
             this, &Dialog::handleSelectedSerialChanged);
+    connect(ui->lockOrientationBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this, &Dialog::applyOrientationLockToOpenVideoForms);
     if (m_themeModeBox) {
         connect(m_themeModeBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
                 this, &Dialog::onThemeModeChanged);
@@ -409,6 +441,18 @@ void Dialog::initGameFeatureUi()
     deviceCenterCropRow->addWidget(m_deviceCenterCropSizeSpin);
     deviceGroupLayout->addLayout(deviceCenterCropRow);
 
+    auto *deviceCodecRow = new QHBoxLayout();
+    deviceCodecRow->setContentsMargins(0, 0, 0, 0);
+    auto *deviceCodecPresetLabel = new QLabel(tr("codec preset:"), m_gameDeviceConfigGroup);
+    deviceCodecRow->addWidget(deviceCodecPresetLabel);
+    m_deviceCodecPresetBox = new QComboBox(m_gameDeviceConfigGroup);
+    m_deviceCodecPresetBox->addItems(EncoderProbe::presetNames());
+    deviceCodecPresetLabel->setBuddy(m_deviceCodecPresetBox);
+    deviceCodecRow->addWidget(m_deviceCodecPresetBox, 1);
+    m_codecBenchmarkBtn = new QPushButton(tr("A/B"), m_gameDeviceConfigGroup);
+    deviceCodecRow->addWidget(m_codecBenchmarkBtn);
+    deviceGroupLayout->addLayout(deviceCodecRow);
+
     groupLayout->addWidget(m_gameDeviceConfigGroup);
 
     connect(m_keymapEditorShortcutEdit, &QKeySequenceEdit::keySequenceChanged,
@@ -417,6 +461,24 @@ void Dialog::initGameFeatureUi()
             this, &Dialog::onSelectedDeviceCenterCropConfigEdited);
     connect(m_deviceCenterCropSizeSpin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
             this, &Dialog::onSelectedDeviceCenterCropConfigEdited);
+    connect(m_deviceCodecPresetBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this, &Dialog::onSelectedDeviceCodecPresetEdited);
+    connect(m_codecBenchmarkBtn, &QPushButton::clicked, this, &Dialog::onCodecBenchmarkClicked);
+
+    // spin box steps arrive one by one, restart after the last of them
+    m_centerCropRestartTimer.setSingleShot(true);
+    m_centerCropRestartTimer.setInterval(1000);
+    connect(&m_centerCropRestartTimer, &QTimer::timeout, this, [this]() {
+        const QSet<QString> serials = m_centerCropRestartSerials;
+        m_centerCropRestartSerials.clear();
+        for (const QString &serial : serials) {
+            if (!m_videoForms.value(serial)) {
+                continue;
+            }
+            outLog(QString("center crop changed, restart server to apply it: %1").arg(serial), false);
+            restartDeviceInPlace(serial);
+        }
+    });
 
     rightLayout->insertWidget(1, m_gameFeatureGroup);
 }
@@ -535,12 +597,14 @@ void Dialog::initControlToolTips()
     const QString maxSizeToolTip = tr("限制视频长边分辨率。值越小越省带宽；original 表示保持设备原始尺寸。");
     const QString maxFpsToolTip = tr("设置全局最大帧率。0 表示不限制；修改后对新启动或重启后的服务生效。");
     const QString formatToolTip = tr("选择录屏文件格式，仅在开启录屏时生效。");
-    const QString orientationToolTip = tr("锁定采集方向。选择具体角度后会强制按该方向采集画面。");
+    const QString orientationToolTip = tr("锁定采集方向。选择具体角度后会强制按该方向采集画面。已打开的投屏窗口会立即在本地旋转画面，无需重连。");
     const QString localTextInputToolTip = tr("启用视频窗口里的本地文本输入浮层。开启后可用右侧快捷键呼出输入框，一次性把文字发送到设备。");
     const QString gameScriptToolTip = tr("选择要绑定到当前设备的视频窗口脚本。点击“应用脚本”后会立即下发到已连接设备。");
     const QString recordScreenToolTip = tr("连接设备时自动开始录制。只影响新启动的会话；运行中的开始和停止请使用视频窗口旁的录制按钮。");
     const QString deviceCenterCropToolTip = tr("为当前设备启用独有的中心裁切参数。开启后只对当前选中设备生效。");
     const QString deviceCenterCropSizeToolTip = tr("设置当前设备中心裁切尺寸，只有开启中心裁切后才会生效。");
+    const QString deviceCodecPresetToolTip = tr("当前设备的编码参数预设：default 使用编码器默认值，lowlatency 为恒定码率、每秒一个关键帧、实时优先级，quality 为可变码率、关键帧间隔更长。config.ini 中的 CodecOptions 不为空时以其为准；正在投屏的设备修改后会自动重启服务生效。");
+    const QString codecBenchmarkToolTip = tr("对当前正在投屏的设备依次使用每个预设重启会话，各采样数秒，在日志中比较帧率、最长卡顿和堆积帧数，结束后恢复当前预设。");
 
     ui->useSingleModeCheck->setToolTip(tr("切换为快捷连接模式。开启后会隐藏右侧高级配置，只保留左侧快速连接入口。"));
     ui->wifiConnectBtn->setToolTip(tr("按预设流程尝试无线连接：刷新设备、读取 IP、切换 adbd 到 tcpip、执行 adb connect，然后启动投屏。设备需要先通过 USB 被 adb 识别。"));
@@ -597,6 +661,12 @@ void Dialog::initControlToolTips()
     if (m_deviceCenterCropSizeSpin) {
         m_deviceCenterCropSizeSpin->setToolTip(deviceCenterCropSizeToolTip);
     }
+    if (m_deviceCodecPresetBox) {
+        m_deviceCodecPresetBox->setToolTip(deviceCodecPresetToolTip);
+    }
+    if (m_codecBenchmarkBtn) {
+        m_codecBenchmarkBtn->setToolTip(codecBenchmarkToolTip);
+    }
     if (m_mouseConfigToggleBtn) {
         m_mouseConfigToggleBtn->setToolTip(buildMouseConfigToggleToolTip());
     }
@@ -837,6 +907,7 @@ void Dialog::updateSelectedDeviceConfigUi(const QString &serial)
 
     const QSignalBlocker centerCropCheckBlocker(m_deviceCenterCropCheck);
     const QSignalBlocker centerCropSizeBlocker(m_deviceCenterCropSizeSpin);
+    const QSignalBlocker codecPresetBlocker(m_deviceCodecPresetBox);
     const QSignalBlocker remoteCursorBlocker(m_renderRemoteCursorCheck);
     const QSignalBlocker cursorSizeBlocker(m_cursorSizeSpin);
     const QSignalBlocker compatBlocker(m_normalMouseCompatEnabledCheck);
@@ -852,6 +923,10 @@ void Dialog::updateSelectedDeviceConfigUi(const QString &serial)
     if (m_deviceCenterCropSizeSpin) {
         m_deviceCenterCropSizeSpin->setValue(centerCropSize);
     }
+    if (m_deviceCodecPresetBox) {
+        const int presetIndex = m_deviceCodecPresetBox->findText(Config::getInstance().getDeviceCodecPreset(trimmedSerial));
+        m_deviceCodecPresetBox->setCurrentIndex(qMax(0, presetIndex));
+    }
     if (m_renderRemoteCursorCheck) {
         m_renderRemoteCursorCheck->setChecked(config.remoteCursorEnabled);
     }
@@ -941,6 +1016,13 @@ void Dialog::saveSelectedDeviceCenterCropConfig()
         }
     }
 
+    // the window reads the crop when a session is attached, a running
+    // session only picks it up through a restart
+    if (m_videoForms.value(serial)) {
+        m_centerCropRestartSerials.insert(serial);
+        m_centerCropRestartTimer.start();
+    }
+
     updateSelectedDeviceConfigControlState();
 }
 
@@ -949,6 +1031,177 @@ void Dialog::onSelectedDeviceCenterCropConfigEdited()
     saveSelectedDeviceCenterCropConfig();
 }
 
+void Dialog::onSelectedDeviceCodecPresetEdited()
+{
+    if (m_updatingSelectedDeviceConfigUi || !m_deviceCodecPresetBox) {
+        return;
+    }
+
+    const QString serial = currentSelectedSerial();
+    if (serial.isEmpty()) {
+        return;
+    }
+
+    Config::getInstance().setDeviceCodecPreset(serial, m_deviceCodecPresetBox->currentText());
+    // codec options are a server start parameter, like the center crop
+    if (m_videoForms.value(serial) && !m_codecBenchmarks.contains(serial)) {
+        restartDeviceInPlace(serial);
+    }
+}
+
+void Dialog::onCodecBenchmarkClicked()
+{
+    const QString serial = currentSelectedSerial();
+    if (serial.isEmpty() || !m_videoForms.value(serial)) {
+        outLog("codec A/B: start mirroring the selected device first");
+        return;
+    }
+    if (!Config::getInstance().getCodecOptions().trimmed().isEmpty()) {
+        outLog("codec A/B: CodecOptions in config.ini overrides every preset");
+        return;
+    }
+    if (m_codecBenchmarks.contains(serial)) {
+        return;
+    }
+
+    static int s_runs = 0;
+    CodecBenchmark benchmark;
+    benchmark.presets = EncoderProbe::presetNames();
+    benchmark.run = ++s_runs;
+    m_codecBenchmarks.insert(serial, benchmark);
+    outLog(QString("codec A/B (%1): %2").arg(serial, benchmark.presets.join(", ")), false);
+    armCodecBenchmarkTimeout(serial);
+    restartDeviceInPlace(serial);
+}
+
+void Dialog::armCodecBenchmarkTimeout(const QString &serial)
+{
+    const CodecBenchmark benchmark = m_codecBenchmarks.value(serial);
+    const int run = benchmark.run;
+    const int index = benchmark.index;
+    QTimer::singleShot(kCodecBenchmarkPresetTimeoutMs, this, [this, serial, run, index]() {
+        const auto it = m_codecBenchmarks.constFind(serial);
+        if (it == m_codecBenchmarks.constEnd() || it->run != run || it->index != index) {
+            return;
+        }
+        // a session that failed to start with the preset, or a screen that sent nothing
+        abortCodecBenchmark(serial, QString("%1 produced no samples").arg(it->presets.at(index)));
+        if (m_videoForms.value(serial)) {
+            restartDeviceInPlace(serial);
+        }
+    });
+}
+
+void Dialog::abortCodecBenchmark(const QString &serial, const QString &reason)
+{
+    if (!m_codecBenchmarks.contains(serial)) {
+        return;
+    }
+    const CodecBenchmark benchmark = m_codecBenchmarks.take(serial);
+    for (int i = 0; i < benchmark.results.size(); ++i) {
+        outLog(QString("codec A/B (%1) %2").arg(serial, benchmark.results.at(i)), false);
+    }
+    outLog(QString("codec A/B (%1) aborted after %2 of %3 presets: %4")
+               .arg(serial).arg(benchmark.results.size()).arg(benchmark.presets.size()).arg(reason), false);
+}
+
+void Dialog::sampleCodecBenchmark(const QString &serial, quint32 frames, qint64 maxGapMs, quint32 burstFrames, qint64 presentLatencyUs)
+{
+    // the first seconds of a session are the key frame and the encoder warming up
+    const int warmupSeconds = 3;
+    const int sampleSeconds = 8;
+
+    CodecBenchmark &benchmark = m_codecBenchmarks[serial];
+    ++benchmark.seconds;
+    if (benchmark.seconds <= warmupSeconds) {
+        return;
+    }
+    benchmark.frames += frames;
+    benchmark.maxGapMs = qMax(benchmark.maxGapMs, maxGapMs);
+    benchmark.burstFrames += burstFrames;
+    if (presentLatencyUs >= 0) {
+        benchmark.latencyUs += static_cast<quint64>(presentLatencyUs);
+        ++benchmark.latencySeconds;
+    }
+    if (benchmark.seconds < warmupSeconds + sampleSeconds) {
+        return;
+    }
+
+    const QString latency = benchmark.latencySeconds > 0
+        ? QString::number(static_cast<double>(benchmark.latencyUs) / benchmark.latencySeconds / 1000.0, 'f', 1)
+        : QString("n/a");
+    benchmark.results.append(QString("%1 at %2 Mbps: %3 fps, decode to present %4 ms, longest stall %5 ms, %6 queued frames")
+                                 .arg(benchmark.presets.at(benchmark.index))
+                                 .arg(benchmark.bitRate / 1000000.0, 0, 'f', 1)
+                                 .arg(static_cast<double>(benchmark.frames) / sampleSeconds, 0, 'f', 1)
+                                 .arg(latency)
+                                 .arg(benchmark.maxGapMs)
+                                 .arg(benchmark.burstFrames));
+    ++benchmark.index;
+    benchmark.seconds = 0;
+    benchmark.frames = 0;
+    benchmark.maxGapMs = 0;
+    benchmark.burstFrames = 0;
+    benchmark.latencyUs = 0;
+    benchmark.latencySeconds = 0;
+
+    if (benchmark.index >= benchmark.presets.size()) {
+        const QStringList results = benchmark.results;
+        m_codecBenchmarks.remove(serial);
+        for (int i = 0; i < results.size(); ++i) {
+            outLog(QString("codec A/B (%1) %2").arg(serial, results.at(i)), false);
+        }
+    } else {
+        armCodecBenchmarkTimeout(serial);
+    }
+    // the next preset, or back to the device's own one
+    restartDeviceInPlace(serial);
+}
+
+void Dialog::probeEncodersIfNeeded(const QString &serial)
+{
+    if (serial.isEmpty() || m_encoderProbes.contains(serial)
+        || !Config::getInstance().getDeviceEncoders(serial).isEmpty()) {
+        return;
+    }
+
+    m_encoderProbes.insert(serial);
+    auto *probe = new EncoderProbe(serial, this);
+    connect(probe, &EncoderProbe::finished, this, &Dialog::onEncodersProbed);
+    probe->start();
+}
+
+void Dialog::dropUntestedCodecName(const QString &serial)
+{
+    const QString codecName = m_untestedCodecNames.take(serial);
+    if (codecName.isEmpty() || codecName != Config::getInstance().getDeviceCodecName(serial)) {
+        return;
+    }
+    // the encoders stay cached, so the probe does not pick the same name again
+    Config::getInstance().setDeviceCodecName(serial, QString());
+    outLog(QString("encoder probe (%1): no frame with %2, the device picks its own from the next session")
+               .arg(serial, codecName), false);
+}
+
+void Dialog::onEncodersProbed(const QString &serial, const QStringList &encoders)
+{
+    m_encoderProbes.remove(serial);
+    if (encoders.isEmpty()) {
+        outLog(QString("encoder probe (%1): no encoders listed, the device picks its own").arg(serial), false);
+        return;
+    }
+
+    Config::getInstance().setDeviceEncoders(serial, encoders);
+    const QString encoder = EncoderProbe::preferredEncoder(encoders);
+    if (Config::getInstance().getDeviceCodecName(serial).isEmpty()) {
+        Config::getInstance().setDeviceCodecName(serial, encoder);
+    }
+    outLog(QString("encoder probe (%1): %2").arg(serial, encoders.join(", ")), false);
+    if (!encoder.isEmpty()) {
+        outLog(QString("encoder probe (%1): %2 from the next session").arg(serial, encoder), false);
+    }
+}
+
 void Dialog::updateBootConfig(bool toView)
 {
     if (toView) {
@@ -1131,13 +1384,23 @@ void Dialog::on_startServerBtn_clicked()
 {
     updateBootConfig(false);
     outLog("start server...", false);
-    qsc::IDeviceManage::getInstance().connectDevice(buildDeviceParams(ui->serialBox->currentText().trimmed()));
+    const QString serial = ui->serialBox->currentText().trimmed();
+    const qint64 startMsecs = VideoForm::startupClockMsecs();
+    if (qsc::IDeviceManage::getInstance().connectDevice(buildDeviceParams(serial))) {
+        prepareDeviceSession(serial, startMsecs);
+    }
 }
 
 void Dialog::on_stopServerBtn_clicked()
 {
-    if (qsc::IDeviceManage::getInstance().disconnectDevice(ui->serialBox->currentText().trimmed())) {
+    const QString serial = ui->serialBox->currentText().trimmed();
+    cancelReconnect(serial);
+    abortCodecBenchmark(serial, "server stopped");
+    m_expectedDisconnects.insert(serial);
+    if (qsc::IDeviceManage::getInstance().disconnectDevice(serial)) {
         outLog("stop server");
+    } else {
+        m_expectedDisconnects.remove(serial);
     }
 }
 
@@ -1275,26 +1538,216 @@ void Dialog::onDeviceConnected(bool success, const QString &serial, const QStrin
 {
     Q_UNUSED(deviceName);
     if (!success) {
+        abortCodecBenchmark(serial, "session failed to start");
+        m_connectStartMsecs.remove(serial);
+        VideoForm *prepared = m_preparedVideoForms.take(serial).data();
+        if (prepared) {
+            prepared->deleteLater();
+        }
+        if (m_reconnects.value(serial).restart) {
+            outLog(QString("restart server failed: %1").arg(serial));
+            cancelReconnect(serial);
+        } else if (m_reconnects.contains(serial)) {
+            // the device dropped before, a failed attempt says nothing about the encoder
+            m_untestedCodecNames.remove(serial);
+            scheduleReconnect(serial);
+            return;
+        }
+        dropUntestedCodecName(serial);
         return;
     }
-    auto videoForm = new VideoForm(ui->framelessCheck->isChecked(), Config::getInstance().getSkin(), ui->showToolbar->isChecked());
-    videoForm->setSerial(serial);
-    videoForm->setInitialOrientationHint(initialOrientation);
-    videoForm->setLocalTextInputConfig(ui->localTextInputCheck->isChecked(), ui->localTextInputShortcutEdit->keySequence());
-    videoForm->setKeymapEditorShortcut(currentKeymapEditorShortcut());
-    connect(videoForm, &VideoForm::restartServiceRequested, this, &Dialog::onRestartDeviceRequested);
-    connect(videoForm, &QObject::destroyed, this, [this, serial]() {
-        m_videoForms.remove(serial);
+    if (m_connectStartMsecs.contains(serial)) {
+        outLog(QString("device connected in %1 ms: %2")
+                   .arg(VideoForm::startupClockMsecs() - m_connectStartMsecs.value(serial))
+                   .arg(serial), false);
+    }
+    probeEncodersIfNeeded(serial);
+
+    // a window waiting for this session goes first, whether or not the wall is on
+    if (m_reconnects.contains(serial)) {
+        if (!videoFormOpen(m_reconnects.value(serial).videoForm)) {
+            // closed while the attempt ran, the new session has no window to stream into
+            outLog(QString("reconnect dropped, window closed: %1").arg(serial), false);
+            cancelReconnect(serial, true);
+            return;
+        }
+        const DeviceReconnect reconnect = m_reconnects.take(serial);
+        if (attachVideoForm(reconnect.videoForm, serial)) {
+            // same window, geometry, keymap and GL resources, only the stream is new;
+            // it is captured with the current orientation lock, nothing left to turn here
+            reconnect.videoForm->setClientRotation(0);
+            // a restart may have been for a new center crop
+            reconnect.videoForm->reloadSessionConfig();
+            GroupController::instance().addDevice(serial);
+            if (reconnect.restartAgain) {
+                QTimer::singleShot(0, this, [this, serial]() {
+                    restartDeviceInPlace(serial);
+                });
+            }
+            if (reconnect.restart) {
+                outLog(QString("restarted in place in %1 ms: %2").arg(reconnect.elapsed.elapsed()).arg(serial), false);
+                return;
+            }
+            reconnect.videoForm->setReconnecting(false, reconnect.elapsed.elapsed());
+            outLog(QString("reconnected in %1 ms after %2 attempts: %3")
+                       .arg(reconnect.elapsed.elapsed()).arg(reconnect.attempt).arg(serial), false);
+            return;
+        }
+        if (reconnect.videoForm) {
+            reconnect.videoForm->close();
+            reconnect.videoForm->deleteLater();
+        }
+    }
+
+    if (Config::getInstance().getDeviceWall()) {
+        if (!m_deviceWall) {
+            m_deviceWall = new DeviceWall();
+            m_deviceWall->setAttribute(Qt::WA_DeleteOnClose);
+            connect(m_deviceWall, &DeviceWall::openDeviceRequested, this, [this](const QString &wallSerial, const QSize &frameSize) {
+                m_deviceWall->removeDevice(wallSerial);
+                openVideoForm(wallSerial, frameSize, -1);
+            });
+        }
+        QString name = Config::getInstance().getNickName(serial);
+        if (name.isEmpty()) {
+            name = serial;
+        }
+        m_deviceWall->addDevice(serial, name);
+        m_deviceWall->show();
+        GroupController::instance().addDevice(serial);
+        return;
+    }
+
+    openVideoForm(serial, size, initialOrientation);
+}
+
+void Dialog::startReconnect(const QString &serial, VideoForm *videoForm)
+{
+    DeviceReconnect reconnect;
+    reconnect.videoForm = videoForm;
+    reconnect.elapsed.start();
+    m_reconnects.insert(serial, reconnect);
+    videoForm->setReconnecting(true);
+    outLog(QString("device lost, reconnecting: %1").arg(serial), false);
+    scheduleReconnect(serial);
+}
+
+void Dialog::scheduleReconnect(const QString &serial)
+{
+    auto it = m_reconnects.find(serial);
+    if (it == m_reconnects.end()) {
+        return;
+    }
+    // a window the user closed meanwhile ends the attempts
+    if (!videoFormOpen(it->videoForm) || it->attempt >= kReconnectMaxAttempts) {
+        outLog(QString("reconnect given up after %1 attempts: %2").arg(it->attempt).arg(serial), false);
+        cancelReconnect(serial);
+        return;
+    }
+
+    const int delayMs = qMin(kReconnectMaxDelayMs, kReconnectBaseDelayMs << qMin(it->attempt, 8));
+    ++it->attempt;
+    QTimer::singleShot(delayMs, this, [this, serial]() {
+        if (!m_reconnects.contains(serial)) {
+            return;
+        }
+        if (!videoFormOpen(m_reconnects.value(serial).videoForm)) {
+            outLog(QString("reconnect given up, window closed: %1").arg(serial), false);
+            cancelReconnect(serial);
+            return;
+        }
+        // false while adb does not list the device again, true hands over to onDeviceConnected
+        if (!qsc::IDeviceManage::getInstance().connectDevice(buildDeviceParams(serial))) {
+            scheduleReconnect(serial);
+        }
     });
-    m_videoForms.insert(serial, videoForm);
-    updateVideoFormScriptBinding(serial, getGameScriptPath(ui->gameBox->currentText()), ui->gameBox->currentText(), getGameScript(ui->gameBox->currentText()));
+}
 
+void Dialog::restartDeviceInPlace(const QString &serial)
+{
+    if (m_reconnects.contains(serial)) {
+        // its parameters may already be built, restart once more after it attached
+        m_reconnects[serial].restartAgain = true;
+        return;
+    }
+    VideoForm *videoForm = m_videoForms.value(serial);
+    if (!videoFormOpen(videoForm)) {
+        onRestartDeviceRequested(serial);
+        return;
+    }
+
+    updateBootConfig(false);
+    outLog(QString("restart server in place: %1").arg(serial), false);
+    DeviceReconnect restart;
+    restart.videoForm = videoForm;
+    restart.restart = true;
+    restart.elapsed.start();
+    m_reconnects.insert(serial, restart);
+    m_expectedDisconnects.insert(serial);
+    if (!qsc::IDeviceManage::getInstance().disconnectDevice(serial)) {
+        m_expectedDisconnects.remove(serial);
+        m_reconnects.remove(serial);
+        outLog(QString("restart server failed: device not found (%1)").arg(serial));
+        return;
+    }
+
+    QTimer::singleShot(0, this, [this, serial]() {
+        if (!m_reconnects.contains(serial)) {
+            return;
+        }
+        if (!qsc::IDeviceManage::getInstance().connectDevice(buildDeviceParams(serial))) {
+            outLog(QString("restart server failed: connect device failed (%1)").arg(serial));
+            cancelReconnect(serial);
+        }
+    });
+}
+
+void Dialog::cancelReconnect(const QString &serial, bool stopSession)
+{
+    if (stopSession) {
+        m_expectedDisconnects.insert(serial);
+        if (!qsc::IDeviceManage::getInstance().disconnectDevice(serial)) {
+            m_expectedDisconnects.remove(serial);
+        }
+    }
+    const DeviceReconnect reconnect = m_reconnects.take(serial);
+    if (reconnect.videoForm) {
+        reconnect.videoForm->close();
+        reconnect.videoForm->deleteLater();
+    }
+}
+
+void Dialog::prepareDeviceSession(const QString &serial, qint64 startMsecs)
+{
+    if (serial.isEmpty()) {
+        return;
+    }
+    m_connectStartMsecs.insert(serial, startMsecs);
+    if (Config::getInstance().getDeviceWall() || m_preparedVideoForms.value(serial)) {
+        return;
+    }
+
+    // the push and server start run in adb processes, the GUI thread is free to build the window
+    QTimer::singleShot(0, this, [this, serial]() {
+        if (!m_connectStartMsecs.contains(serial) || m_preparedVideoForms.value(serial)) {
+            return;
+        }
+        m_preparedVideoForms.insert(serial, new VideoForm(ui->framelessCheck->isChecked(), Config::getInstance().getSkin(),
+                                                          ui->showToolbar->isChecked()));
+    });
+}
+
+bool Dialog::attachVideoForm(VideoForm *videoForm, const QString &serial)
+{
     auto device = qsc::IDeviceManage::getInstance().getDevice(serial);
     if (!device) {
-        videoForm->deleteLater();
-        return;
+        return false;
     }
 
+    m_videoForms.insert(serial, videoForm);
+    m_sessionOrientationLocks.insert(serial, ui->lockOrientationBox->currentIndex());
+    updateVideoFormScriptBinding(serial, getGameScriptPath(ui->gameBox->currentText()), ui->gameBox->currentText(), getGameScript(ui->gameBox->currentText()));
+
     connect(device.data(), &qsc::IDevice::recordingError, this,
             [this, serial](const QString &emittedSerial, const QString &message) {
         if (emittedSerial != serial || message.trimmed().isEmpty()) {
@@ -1316,7 +1769,40 @@ void Dialog::onDeviceConnected(bool success, const QString &serial, const QStrin
 
     device->setUserData(static_cast<void*>(videoForm));
     device->registerDeviceObserver(videoForm);
+    return true;
+}
 
+void Dialog::openVideoForm(const QString &serial, const QSize &size, int initialOrientation)
+{
+    const qint64 connectedMsecs = VideoForm::startupClockMsecs();
+    VideoForm *videoForm = m_preparedVideoForms.take(serial).data();
+    if (!videoForm) {
+        videoForm = new VideoForm(ui->framelessCheck->isChecked(), Config::getInstance().getSkin(), ui->showToolbar->isChecked());
+    }
+    if (m_connectStartMsecs.contains(serial)) {
+        videoForm->setStartupTimes(m_connectStartMsecs.take(serial), connectedMsecs);
+    }
+    videoForm->setSerial(serial);
+    videoForm->setInitialOrientationHint(initialOrientation);
+    videoForm->setLocalTextInputConfig(ui->localTextInputCheck->isChecked(), ui->localTextInputShortcutEdit->keySequence());
+    videoForm->setKeymapEditorShortcut(currentKeymapEditorShortcut());
+    connect(videoForm, &VideoForm::restartServiceRequested, this, &Dialog::onRestartDeviceRequested);
+    connect(videoForm, &VideoForm::thumbnailUpdated, this, &Dialog::onThumbnailUpdated);
+    if (Config::getInstance().getAutoMaxSize()) {
+        connect(videoForm, &VideoForm::maxSizeSuggested, this, &Dialog::onMaxSizeSuggested);
+    }
+    connect(videoForm, &VideoForm::streamHealthSampled, this, &Dialog::onStreamHealthSampled);
+    // queued, the form emits from inside its frame callback
+    connect(videoForm, &VideoForm::backgroundThrottleChanged, this, &Dialog::onBackgroundThrottleChanged, Qt::QueuedConnection);
+    // a new window starts shown, whatever the previous one was
+    m_backgroundThrottled.remove(serial);
+    connect(videoForm, &QObject::destroyed, this, [this, serial]() {
+        m_videoForms.remove(serial);
+    });
+    if (!attachVideoForm(videoForm, serial)) {
+        videoForm->deleteLater();
+        return;
+    }
 
     videoForm->showFPS(ui->fpsCheck->isChecked());
 
@@ -1333,7 +1819,9 @@ void Dialog::onDeviceConnected(bool success, const QString &serial, const QStrin
         name = Config::getInstance().getTitle();
     }
     videoForm->setWindowTitle(name + "-" + serial);
-    videoForm->updateShowSize(size);
+    if (size.isValid()) {
+        videoForm->updateShowSize(size);
+    }
 
     bool deviceVer = size.height() > size.width();
     QRect rc = Config::getInstance().getRect(serial);
@@ -1347,7 +1835,8 @@ void Dialog::onDeviceConnected(bool success, const QString &serial, const QStrin
 
 #ifdef Q_OS_WIN32
     // windows是show太早可以看到resize的过程
-    QTimer::singleShot(200, videoForm, [videoForm](){videoForm->show();});
+    // the geometry is already set, one event loop turn lets the posted layout requests settle
+    QTimer::singleShot(0, videoForm, [videoForm](){videoForm->show();});
 #endif
 
     GroupController::instance().addDevice(serial);
@@ -1364,7 +1853,10 @@ void Dialog::onRestartDeviceRequested(const QString &serial)
     updateBootConfig(false);
     outLog(QString("restart server: %1").arg(trimmedSerial), false);
 
+    m_expectedDisconnects.insert(trimmedSerial);
     if (!qsc::IDeviceManage::getInstance().disconnectDevice(trimmedSerial)) {
+        m_expectedDisconnects.remove(trimmedSerial);
+        abortCodecBenchmark(trimmedSerial, "restart failed");
         outLog(QString("restart server failed: device not found (%1)").arg(trimmedSerial));
         return;
     }
@@ -1375,15 +1867,133 @@ void Dialog::onRestartDeviceRequested(const QString &serial)
             outLog("restart server failed: serial is empty");
             return;
         }
+        const qint64 startMsecs = VideoForm::startupClockMsecs();
         if (!qsc::IDeviceManage::getInstance().connectDevice(params)) {
+            abortCodecBenchmark(trimmedSerial, "restart failed");
             outLog(QString("restart server failed: connect device failed (%1)").arg(trimmedSerial));
+            return;
         }
+        prepareDeviceSession(trimmedSerial, startMsecs);
     });
 }
 
+void Dialog::onThumbnailUpdated(const QString &serial, const QImage &thumbnail)
+{
+    m_thumbnails.insert(serial, thumbnail);
+    const int row = ui->serialBox->findText(serial);
+    QListWidgetItem *item = row >= 0 ? ui->connectedPhoneList->item(row) : nullptr;
+    if (item) {
+        item->setData(Qt::DecorationRole, thumbnail);
+    }
+}
+
+void Dialog::onMaxSizeSuggested(const QString &serial, int longSide)
+{
+    // this is ok that "original" toInt is 0
+    const int limit = ui->maxSizeBox->currentText().trimmed().toInt();
+    int maxSize = limit;
+    for (int i = 0; i < ui->maxSizeBox->count(); ++i) {
+        const int step = ui->maxSizeBox->itemText(i).trimmed().toInt();
+        if (step >= longSide && (0 == limit || step <= limit)) {
+            maxSize = step;
+            break;
+        }
+    }
+
+    const int current = m_autoMaxSizes.value(serial, limit);
+    if (maxSize == current) {
+        return;
+    }
+    // no in-session encoder reset, the new size takes a server restart into the resized window
+    m_autoMaxSizes.insert(serial, maxSize);
+    outLog(QString("auto max size: %1 -> %2 (%3)").arg(current).arg(maxSize).arg(serial), false);
+    restartDeviceInPlace(serial);
+}
+
+void Dialog::onBackgroundThrottleChanged(const QString &serial, bool throttled)
+{
+    if (throttled == m_backgroundThrottled.contains(serial)) {
+        return;
+    }
+    if (!videoFormOpen(m_videoForms.value(serial))) {
+        // closing, a restart would only reopen what the user closed
+        m_backgroundThrottled.remove(serial);
+        return;
+    }
+    if (throttled) {
+        m_backgroundThrottled.insert(serial);
+    } else {
+        m_backgroundThrottled.remove(serial);
+    }
+    outLog(QString("background throttle (%1): %2").arg(serial, throttled ? "hidden, lowering fps and bitrate" : "shown, restoring fps and bitrate"), false);
+    // into the same window, it keeps its last frame until the new session delivers
+    restartDeviceInPlace(serial);
+}
+
+void Dialog::onStreamHealthSampled(const QString &serial, quint32 frames, qint64 maxGapMs, quint32 burstFrames, qint64 presentLatencyUs)
+{
+    if (frames > 0) {
+        m_untestedCodecNames.remove(serial);
+    }
+    if (m_backgroundThrottled.contains(serial)) {
+        // a slowed hidden session says nothing about the link
+        return;
+    }
+    if (m_codecBenchmarks.contains(serial)) {
+        sampleCodecBenchmark(serial, frames, maxGapMs, burstFrames, presentLatencyUs);
+        return;
+    }
+    if (!Config::getInstance().getAdaptiveBitRate() || !isWifiSerial(serial)) {
+        return;
+    }
+
+    BitRateController &controller = m_bitRateControllers[serial];
+    // bounds follow the dialog, the user's bitrate and max fps are the ceiling
+    controller.setBounds(Config::getInstance().getAdaptiveBitRateMin(), getBitRate(),
+                         static_cast<quint32>(qBound(0, ui->maxFpsSpin->value(), 240)));
+    controller.setLatencyTarget(Config::getInstance().getAdaptiveLatencyTarget());
+
+    BitRateController::Sample sample;
+    sample.frames = frames;
+    sample.maxGapMs = maxGapMs;
+    sample.burstFrames = burstFrames;
+    QString reason;
+    if (!controller.addSample(sample, &reason)) {
+        // the controller gives a no-op reason once, when it reaches the floor
+        if (!reason.isEmpty()) {
+            outLog(QString("adaptive bitrate (%1): %2").arg(serial, reason), false);
+        }
+        return;
+    }
+    // no in-session encoder reset, the new settings take a server restart;
+    // keeping the window spares the congested link a blank window and a new one
+    outLog(QString("adaptive bitrate (%1): %2").arg(serial, reason), false);
+    restartDeviceInPlace(serial);
+}
+
 void Dialog::onDeviceDisconnected(QString serial)
 {
+    const bool expected = m_expectedDisconnects.remove(serial);
+    if (!expected) {
+        // the benchmark's own restarts are expected, anything else ends it
+        abortCodecBenchmark(serial, "device disconnected");
+        // a server that quits before the first frame could not open the encoder
+        dropUntestedCodecName(serial);
+    } else {
+        m_untestedCodecNames.remove(serial);
+    }
     m_videoForms.remove(serial);
+    m_sessionOrientationLocks.remove(serial);
+    if (m_thumbnails.remove(serial)) {
+        const int row = ui->serialBox->findText(serial);
+        QListWidgetItem *item = row >= 0 ? ui->connectedPhoneList->item(row) : nullptr;
+        if (item) {
+            item->setData(Qt::DecorationRole, QVariant());
+        }
+    }
+    if (m_deviceWall) {
+        m_deviceWall->removeDevice(serial);
+    }
     GroupController::instance().removeDevice(serial);
     auto device = qsc::IDeviceManage::getInstance().getDevice(serial);
     if (!device) {
@@ -1393,6 +2003,16 @@ void Dialog::onDeviceDisconnected(QString serial)
     if (data) {
         VideoForm* vf = static_cast<VideoForm*>(data);
         qsc::IDeviceManage::getInstance().getDevice(serial)->deRegisterDeviceObserver(vf);
+        if (expected && m_reconnects.value(serial).videoForm == vf) {
+            // restarted in place, the window waits for the new session
+            device->setUserData(nullptr);
+            return;
+        }
+        if (!expected && !vf->closeRequested() && Config::getInstance().getAutoReconnect()) {
+            device->setUserData(nullptr);
+            startReconnect(serial, vf);
+            return;
+        }
         vf->close();
         vf->deleteLater();
     }
@@ -1663,10 +2283,26 @@ qsc::DeviceParams Dialog::buildDeviceParams(const QString &serial)
         Config::getInstance().ensureDeviceMouseConfigInitialized(trimmedSerial);
     }
     qsc::DeviceParams params;
+    if (Config::getInstance().getAutoMaxSize() && m_autoMaxSizes.contains(trimmedSerial)) {
+        // never above what maxSizeBox allows, it may have been lowered since
+        const quint16 autoSize = static_cast<quint16>(m_autoMaxSizes.value(trimmedSerial));
+        if (0 == videoSize || (0 != autoSize && autoSize < videoSize)) {
+            videoSize = autoSize;
+        }
+    }
     params.serial = trimmedSerial;
     params.maxSize = videoSize;
     params.bitRate = getBitRate();
     params.maxFps = static_cast<quint32>(qBound(0, ui->maxFpsSpin->value(), 240));
+    if (Config::getInstance().getAdaptiveBitRate() && m_bitRateControllers.contains(trimmedSerial)) {
+        const BitRateController controller = m_bitRateControllers.value(trimmedSerial);
+        params.bitRate = qMin(params.bitRate, controller.bitRate());
+        params.maxFps = controller.maxFps();
+    }
+    if (m_backgroundThrottled.contains(trimmedSerial)) {
+        params.bitRate = qMin(params.bitRate, kBackgroundBitRate);
+        params.maxFps = 0 == params.maxFps ? kBackgroundMaxFps : qMin(params.maxFps, kBackgroundMaxFps);
+    }
     params.closeScreen = ui->closeScreenCheck->isChecked();
     params.useReverse = ui->useReverseCheck->isChecked();
     params.display = !ui->notDisplayCheck->isChecked();
@@ -1686,6 +2322,26 @@ qsc::DeviceParams Dialog::buildDeviceParams(const QString &serial)
     params.logLevel = Config::getInstance().getLogLevel();
     params.codecOptions = Config::getInstance().getCodecOptions();
     params.codecName = Config::getInstance().getCodecName();
+    // the global config.ini values win, otherwise the device's probed encoder and preset
+    if (params.codecName.trimmed().isEmpty()) {
+        params.codecName = Config::getInstance().getDeviceCodecName(trimmedSerial);
+        // the probed name is only trusted once a session delivered a frame with it
+        if (!params.codecName.isEmpty()) {
+            m_untestedCodecNames.insert(trimmedSerial, params.codecName);
+        }
+    } else {
+        m_untestedCodecNames.remove(trimmedSerial);
+    }
+    if (params.codecOptions.trimmed().isEmpty()) {
+        const auto benchmark = m_codecBenchmarks.find(trimmedSerial);
+        QString preset = Config::getInstance().getDeviceCodecPreset(trimmedSerial);
+        if (benchmark != m_codecBenchmarks.end() && benchmark->index < benchmark->presets.size()) {
+            preset = benchmark->presets.at(benchmark->index);
+            // reported with the preset's result
+            benchmark->bitRate = params.bitRate;
+        }
+        params.codecOptions = EncoderProbe::presetCodecOptions(preset);
+    }
     params.scid = QRandomGenerator::global()->bounded(1, 10000) & 0x7FFFFFFF;
     return params;
 }
@@ -1717,6 +2373,51 @@ void Dialog::applyKeymapEditorShortcutToOpenVideoForms()
     }
 }
 
+void Dialog::applyOrientationLockToOpenVideoForms()
+{
+    // index 0 is "no lock", then 0/90/180/270; the server keeps the orientation
+    // a session started with and the difference is turned in the renderer
+    const int index = ui->lockOrientationBox->currentIndex();
+    QStringList restartSerials;
+    for (auto it = m_videoForms.begin(); it != m_videoForms.end();) {
+        if (it.value().isNull()) {
+            it = m_videoForms.erase(it);
+            continue;
+        }
+        const int sessionIndex = m_sessionOrientationLocks.value(it.key(), 0);
+        if (index == sessionIndex) {
+            it.value()->setClientRotation(0);
+            ++it;
+            continue;
+        }
+        if (index <= 0) {
+            // a locked stream can not follow the device, only a new session does
+            restartSerials.append(it.key());
+            ++it;
+            continue;
+        }
+        int sessionQuarterTurns = sessionIndex - 1;
+        if (sessionIndex <= 0) {
+            // an unlocked stream follows the display, Android counts its rotation
+            // counter-clockwise and the lock angles clockwise
+            const int rotation = it.value()->deviceRotation();
+            if (rotation < 0) {
+                restartSerials.append(it.key());
+                ++it;
+                continue;
+            }
+            sessionQuarterTurns = (4 - rotation) % 4;
+        }
+        it.value()->setClientRotation(index - 1 - sessionQuarterTurns);
+        ++it;
+    }
+    // after the loop, a restart takes the form out of m_videoForms
+    for (int i = 0; i < restartSerials.size(); ++i) {
+        outLog(QString("orientation lock needs a new session: %1").arg(restartSerials.at(i)), false);
+        restartDeviceInPlace(restartSerials.at(i));
+    }
+}
+
 void Dialog::updateVideoFormScriptBinding(const QString &serial, const QString &scriptFilePath, const QString &scriptDisplayName, const QString &scriptJson)
 {
     auto it = m_videoForms.find(serial);
@@ -8,7 +8,10 @@
 #include <QSystemTrayIcon>
 #include <QListWidget>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QSet>
+#include <QImage>
 #include <QKeySequence>
 
 
@@ -16,6 +19,7 @@
 #include "config.h"
 #include "../QtScrcpyCore/include/QtScrcpyCore.h"
 #include "audio/audiooutput.h"
+#include "bitratecontroller.h"
 
 namespace Ui
 {
@@ -24,11 +28,13 @@ namespace Ui
 
 class QYUVOpenGLWidget;
 class VideoForm;
+class DeviceWall;
 class QCheckBox;
 class QComboBox;
 class QGroupBox;
 class QKeySequenceEdit;
 class QLabel;
+class QPushButton;
 class QSpinBox;
 class QToolButton;
 class QWidget;
@@ -53,6 +59,10 @@ private slots:
     void on_stopServerBtn_clicked();
     void on_restartServerBtn_clicked();
     void onRestartDeviceRequested(const QString &serial);
+    void onThumbnailUpdated(const QString &serial, const QImage &thumbnail);
+    void onMaxSizeSuggested(const QString &serial, int longSide);
+    void onStreamHealthSampled(const QString &serial, quint32 frames, qint64 maxGapMs, quint32 burstFrames, qint64 presentLatencyUs);
+    void onBackgroundThrottleChanged(const QString &serial, bool throttled);
     void on_wirelessConnectBtn_clicked();
     void on_startAdbdBtn_clicked();
     void on_getIPBtn_clicked();
@@ -88,6 +98,9 @@ private slots:
     void showIpEditMenu(const QPoint &pos);
     void onSelectedDeviceMouseConfigEdited();
     void onSelectedDeviceCenterCropConfigEdited();
+    void onSelectedDeviceCodecPresetEdited();
+    void onCodecBenchmarkClicked();
+    void onEncodersProbed(const QString &serial, const QStringList &encoders);
     void onThemeModeChanged(int index);
 
 private:
@@ -107,6 +120,7 @@ private:
     const QString &getServerPath();
     void applyLocalTextInputConfigToOpenVideoForms();
     void applyKeymapEditorShortcutToOpenVideoForms();
+    void applyOrientationLockToOpenVideoForms();
     void updateVideoFormScriptBinding(const QString &serial, const QString &scriptFilePath, const QString &scriptDisplayName, const QString &scriptJson);
     void loadIpHistory();
     void saveIpHistory(const QString &ip);
@@ -114,6 +128,7 @@ private:
     void savePortHistory(const QString &port);
     void restartApplication();
     void quitApplicationDirectly();
+    void openVideoForm(const QString &serial, const QSize &size, int initialOrientation);
     void showPortEditMenu(const QPoint &pos);
     void handleSelectedSerialChanged(const QString &serial);
     void initControlToolTips();
@@ -123,6 +138,24 @@ private:
     void setMouseConfigExpanded(bool expanded);
     void saveSelectedDeviceMouseConfig();
     void saveSelectedDeviceCenterCropConfig();
+    void probeEncodersIfNeeded(const QString &serial);
+    // clears the cached CodecName of a session that ended before its first frame
+    void dropUntestedCodecName(const QString &serial);
+    // once connectDevice accepted the session: keeps the startup clock read
+    // right before it and builds the window while the server starts
+    void prepareDeviceSession(const QString &serial, qint64 startMsecs);
+    // registers videoForm as the observer of serial's current device
+    bool attachVideoForm(VideoForm *videoForm, const QString &serial);
+    // restart with the current parameters, the new session streams into the open window
+    void restartDeviceInPlace(const QString &serial);
+    void startReconnect(const QString &serial, VideoForm *videoForm);
+    void scheduleReconnect(const QString &serial);
+    // stopSession also disconnects a session that connected for the dropped window
+    void cancelReconnect(const QString &serial, bool stopSession = false);
+    void sampleCodecBenchmark(const QString &serial, quint32 frames, qint64 maxGapMs, quint32 burstFrames, qint64 presentLatencyUs);
+    void armCodecBenchmarkTimeout(const QString &serial);
+    // drops a running A/B and logs what it measured so far
+    void abortCodecBenchmark(const QString &serial, const QString &reason);
     int currentAutoUpdateIntervalSec() const;
     int currentAutoUpdateIntervalMs() const;
     void applyAutoUpdateTimerState();
@@ -151,7 +184,64 @@ private:
     QAction *m_quit;
     AudioOutput m_audioOutput;
     QTimer m_autoUpdatetimer;
+    // sessions whose center crop changed, restarted in place once editing
+    // settles so the window crops and maps touches with the new size
+    QTimer m_centerCropRestartTimer;
+    QSet<QString> m_centerCropRestartSerials;
     QHash<QString, QPointer<VideoForm>> m_videoForms;
+    // hidden windows built while the server starts, taken by openVideoForm()
+    QHash<QString, QPointer<VideoForm>> m_preparedVideoForms;
+    // VideoForm::startupClockMsecs() of each pending connectDevice
+    QHash<QString, qint64> m_connectStartMsecs;
+    // windows kept until a new session is attached: devices that dropped
+    // (AutoReconnect) and sessions restarted in place
+    struct DeviceReconnect
+    {
+        QPointer<VideoForm> videoForm;
+        // restartDeviceInPlace(), a failed connect closes the window instead of retrying
+        bool restart = false;
+        // parameters changed while connecting, restart again once attached
+        bool restartAgain = false;
+        int attempt = 0;
+        QElapsedTimer elapsed;
+    };
+    QHash<QString, DeviceReconnect> m_reconnects;
+    // stop and restart disconnects, never reconnected
+    QSet<QString> m_expectedDisconnects;
+    QPointer<DeviceWall> m_deviceWall;
+    // latest VideoForm preview per serial, shown as the connectedPhoneList icon
+    QHash<QString, QImage> m_thumbnails;
+    // lockOrientationBox index each open session was started with
+    QHash<QString, int> m_sessionOrientationLocks;
+    // AutoMaxSize: maxSizeBox step picked from each device's window, 0 is original
+    QHash<QString, int> m_autoMaxSizes;
+    // AdaptiveBitRate: Wi-Fi sessions, kept across the restarts they trigger
+    QHash<QString, BitRateController> m_bitRateControllers;
+    // BackgroundThrottle: sessions whose window is hidden past the grace period
+    QSet<QString> m_backgroundThrottled;
+    // probed CodecName of each session that has not delivered a frame yet
+    QHash<QString, QString> m_untestedCodecNames;
+    // serials with an EncoderProbe running
+    QSet<QString> m_encoderProbes;
+    // A/B run of the codec presets on one session, a restart per preset
+    struct CodecBenchmark
+    {
+        QStringList presets;
+        // tells a stale preset timeout from the current run
+        int run = 0;
+        int index = 0;
+        int seconds = 0;
+        quint64 frames = 0;
+        qint64 maxGapMs = 0;
+        quint64 burstFrames = 0;
+        // summed per second averages, and the seconds that had presented frames
+        quint64 latencyUs = 0;
+        int latencySeconds = 0;
+        // the session's configured bitrate, set when the preset's params are built
+        quint32 bitRate = 0;
+        QStringList results;
+    };
+    QHash<QString, CodecBenchmark> m_codecBenchmarks;
     QComboBox *m_themeModeBox = nullptr;
     QGroupBox *m_gameFeatureGroup = nullptr;
     QGroupBox *m_gameDeviceConfigGroup = nullptr;
@@ -160,6 +250,8 @@ private:
     QLabel *m_selectedDeviceSerialValue = nullptr;
     QCheckBox *m_deviceCenterCropCheck = nullptr;
     QSpinBox *m_deviceCenterCropSizeSpin = nullptr;
+    QComboBox *m_deviceCodecPresetBox = nullptr;
+    QPushButton *m_codecBenchmarkBtn = nullptr;
     QToolButton *m_mouseConfigToggleBtn = nullptr;
     QWidget *m_mouseConfigContent = nullptr;
     QCheckBox *m_renderRemoteCursorCheck = nullptr;
@@ -0,0 +1,186 @@
+#include <QDebug>
+#include <QRegularExpression>
+#include <QTimer>
+
+#include "encoderprobe.h"
+
+namespace {
+constexpr int kProbeTimeoutMs = 5000;
+const char *const kH264Mime = "video/avc";
+
+// the first preset is what a device without a choice runs with
+struct CodecPreset
+{
+    const char *name;
+    const char *options;
+};
+const CodecPreset kCodecPresets[] = {
+    { "default", "" },
+    // constant bitrate, a key frame every second, realtime priority
+    { "lowlatency", "bitrate-mode=2,i-frame-interval=1,priority=0,latency=1" },
+    // variable bitrate and rare key frames, spends the bits on detail
+    { "quality", "bitrate-mode=1,i-frame-interval=10" },
+};
+
+bool isSoftwareEncoder(const QString &name)
+{
+    return name.startsWith("c2.android.", Qt::CaseInsensitive) || name.startsWith("OMX.google.", Qt::CaseInsensitive);
+}
+} // namespace
+
+EncoderProbe::EncoderProbe(const QString &serial, QObject *parent)
+    : QObject(parent)
+    , m_serial(serial.trimmed())
+{
+}
+
+void EncoderProbe::start()
+{
+    QString adbPath = QString::fromLocal8Bit(qgetenv("QTSCRCPY_ADB_PATH"));
+    if (adbPath.trimmed().isEmpty()) {
+        adbPath = "adb";
+    }
+
+    QStringList args;
+    if (!m_serial.isEmpty()) {
+        args << "-s" << m_serial;
+    }
+    // every partition may add codecs, missing files are fine
+    args << "shell" << "cat /vendor/etc/media_codecs*.xml /odm/etc/media_codecs*.xml /system/etc/media_codecs*.xml 2>/dev/null";
+
+    m_process = new QProcess(this);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &EncoderProbe::onProcessFinished);
+    connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (QProcess::FailedToStart == error) {
+            qWarning() << "Encoder probe failed to start adb:" << m_serial;
+            finish(QStringList());
+        }
+    });
+    QTimer::singleShot(kProbeTimeoutMs, this, [this]() {
+        if (!m_finished) {
+            qWarning() << "Encoder probe timed out:" << m_serial;
+            if (m_process) {
+                m_process->kill();
+            }
+            finish(QStringList());
+        }
+    });
+    m_process->start(adbPath, args);
+}
+
+void EncoderProbe::onProcessFinished(int exitCode, QProcess::ExitStatus status)
+{
+    Q_UNUSED(exitCode);
+    Q_UNUSED(status);
+    if (!m_process) {
+        return;
+    }
+    // cat fails when one glob matches nothing, whatever it did print is still good
+    finish(parseEncoders(QString::fromUtf8(m_process->readAllStandardOutput())));
+}
+
+void EncoderProbe::finish(const QStringList &encoders)
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    emit finished(m_serial, encoders);
+    deleteLater();
+}
+
+QStringList EncoderProbe::parseEncoders(const QString &mediaCodecsXml)
+{
+    // several files back to back are no single XML document, walk the tags instead
+    static const QRegularExpression tagRegExp("<(/?)(Encoders|MediaCodec|Type)\\b([^>]*)>");
+    static const QRegularExpression nameRegExp("\\bname\\s*=\\s*\"([^\"]*)\"");
+    static const QRegularExpression typeRegExp("\\btype\\s*=\\s*\"([^\"]*)\"");
+
+    QStringList encoders;
+    bool inEncoders = false;
+    QString codecName;
+    auto addEncoder = [&encoders](const QString &mime, const QString &name) {
+        const QString entry = mime + " " + name;
+        if (mime.startsWith("video/") && !name.isEmpty() && !encoders.contains(entry)) {
+            encoders.append(entry);
+        }
+    };
+
+    QRegularExpressionMatchIterator it = tagRegExp.globalMatch(mediaCodecsXml);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch tag = it.next();
+        const bool closing = !tag.captured(1).isEmpty();
+        const QString element = tag.captured(2);
+        const QString attributes = tag.captured(3);
+
+        if ("Encoders" == element) {
+            inEncoders = !closing;
+            continue;
+        }
+        if (!inEncoders) {
+            continue;
+        }
+        if ("MediaCodec" == element) {
+            if (closing) {
+                codecName.clear();
+                continue;
+            }
+            codecName = nameRegExp.match(attributes).captured(1);
+            // <MediaCodec name="..." type="..."/> carries its type inline
+            const QString mime = typeRegExp.match(attributes).captured(1);
+            if (!mime.isEmpty()) {
+                addEncoder(mime, codecName);
+            }
+            if (attributes.trimmed().endsWith('/')) {
+                codecName.clear();
+            }
+        } else if (!closing && !codecName.isEmpty()) {
+            addEncoder(nameRegExp.match(attributes).captured(1), codecName);
+        }
+    }
+    return encoders;
+}
+
+QString EncoderProbe::preferredEncoder(const QStringList &encoders)
+{
+    // Codec2 first: Android 12+ registers only Codec2, the XML may still list stale OMX entries
+    QString omxEncoder;
+    for (int i = 0; i < encoders.size(); ++i) {
+        const QString mime = encoders.at(i).section(' ', 0, 0);
+        const QString name = encoders.at(i).section(' ', 1);
+        if (mime != kH264Mime || name.contains("secure", Qt::CaseInsensitive) || isSoftwareEncoder(name)) {
+            continue;
+        }
+        if (!name.startsWith("OMX.", Qt::CaseInsensitive)) {
+            return name;
+        }
+        if (omxEncoder.isEmpty()) {
+            omxEncoder = name;
+        }
+    }
+    if (!omxEncoder.isEmpty()) {
+        return omxEncoder;
+    }
+    // only a software encoder: the device default is no worse
+    return QString();
+}
+
+QStringList EncoderProbe::presetNames()
+{
+    QStringList names;
+    for (const CodecPreset &preset : kCodecPresets) {
+        names.append(preset.name);
+    }
+    return names;
+}
+
+QString EncoderProbe::presetCodecOptions(const QString &preset)
+{
+    for (const CodecPreset &codecPreset : kCodecPresets) {
+        if (preset == codecPreset.name) {
+            return codecPreset.options;
+        }
+    }
+    return QString();
+}
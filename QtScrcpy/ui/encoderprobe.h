@@ -0,0 +1,45 @@
+#ifndef ENCODERPROBE_H
+#define ENCODERPROBE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QProcess>
+#include <QStringList>
+
+// Lists the video encoders of one device from the media_codecs XML files its
+// vendor ships, over adb shell, without running the server. Entries are
+// "mime name", for example "video/avc c2.qti.avc.encoder". The probe deletes
+// itself once finished() was emitted.
+class EncoderProbe : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EncoderProbe(const QString &serial, QObject *parent = nullptr);
+
+    void start();
+
+    static QStringList parseEncoders(const QString &mediaCodecsXml);
+    // The H.264 hardware encoder to ask for, Codec2 before OMX; empty leaves the
+    // choice to the device. H.264 is the only codec the client decodes. The XML
+    // is no proof the name is registered, see Dialog::dropUntestedCodecName().
+    static QString preferredEncoder(const QStringList &encoders);
+
+    // option presets for the server's codec options, "key[:type]=value,..."
+    static QStringList presetNames();
+    // empty for an unknown name, the encoder defaults apply
+    static QString presetCodecOptions(const QString &preset);
+
+signals:
+    // empty when the device could not be read
+    void finished(const QString &serial, const QStringList &encoders);
+
+private:
+    void onProcessFinished(int exitCode, QProcess::ExitStatus status);
+    void finish(const QStringList &encoders);
+
+    QString m_serial;
+    QPointer<QProcess> m_process;
+    bool m_finished = false;
+};
+
+#endif // ENCODERPROBE_H
@@ -2,19 +2,21 @@
 
 #include <cmath>
 #include <QMouseEvent>
-#include <QPainter>
+#include <QWidget>
+
+#include "yuvoverlay.h"
 
 namespace {
-constexpr int kHandleRadius = 10;
 constexpr int kHitDistance = 14;
 }
 
-KeymapEditorOverlay::KeymapEditorOverlay(QWidget *parent)
-    : QWidget(parent)
+KeymapEditorOverlay::KeymapEditorOverlay(QWidget *target, QObject *parent)
+    : QObject(parent)
+    , m_target(target)
 {
-    setAttribute(Qt::WA_NoSystemBackground, false);
-    setAttribute(Qt::WA_StyledBackground, false);
-    setMouseTracking(true);
+    if (m_target) {
+        m_target->installEventFilter(this);
+    }
 }
 
 void KeymapEditorOverlay::setDocument(KeymapEditorDocument *document)
@@ -31,16 +33,16 @@ void KeymapEditorOverlay::setDocument(KeymapEditorDocument *document)
     if (m_document) {
         connect(m_document, &KeymapEditorDocument::documentReset, this, [this]() {
             m_selectedNodeId = -1;
-            update();
+            emit changed();
         });
         connect(m_document, &KeymapEditorDocument::nodeListChanged, this, [this]() {
-            update();
+            emit changed();
         });
         connect(m_document, &KeymapEditorDocument::nodeChanged, this, [this](int) {
-            update();
+            emit changed();
         });
     }
-    update();
+    emit changed();
 }
 
 void KeymapEditorOverlay::setSelectedNodeId(int nodeId)
@@ -49,7 +51,7 @@ void KeymapEditorOverlay::setSelectedNodeId(int nodeId)
         return;
     }
     m_selectedNodeId = nodeId;
-    update();
+    emit changed();
 }
 
 int KeymapEditorOverlay::selectedNodeId() const
@@ -57,14 +59,24 @@ int KeymapEditorOverlay::selectedNodeId() const
     return m_selectedNodeId;
 }
 
-void KeymapEditorOverlay::paintEvent(QPaintEvent *event)
+void KeymapEditorOverlay::setActive(bool active)
 {
-    Q_UNUSED(event)
+    if (m_active == active) {
+        return;
+    }
+    m_active = active;
+    resetDragState();
+    emit changed();
+}
 
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing, true);
-    painter.fillRect(rect(), QColor(0, 0, 0, 48));
+bool KeymapEditorOverlay::isActive() const
+{
+    return m_active;
+}
 
+void KeymapEditorOverlay::appendTo(YuvOverlay &overlay) const
+{
+    overlay.dimColor = QColor(0, 0, 0, 48);
     if (!m_document) {
         return;
     }
@@ -72,34 +84,63 @@ void KeymapEditorOverlay::paintEvent(QPaintEvent *event)
     const QVector<KeymapEditorDocument::NodeInfo> nodes = m_document->nodeInfos();
     for (int i = 0; i < nodes.size(); ++i) {
         const KeymapEditorDocument::NodeInfo &info = nodes.at(i);
+        YuvOverlay::Line line;
         if (info.type == KeymapEditorDocument::NodeDrag && info.hasPrimaryPos && info.hasSecondaryPos) {
-            painter.setPen(QPen(QColor(120, 200, 255, 190), 2.0));
-            painter.drawLine(toPixel(info.primaryPos), toPixel(info.secondaryPos));
+            line.from = info.primaryPos;
+            line.to = info.secondaryPos;
+            line.color = QColor(120, 200, 255, 190);
+            line.width = 2.0;
         } else if (info.type == KeymapEditorDocument::NodeMouseMove && info.hasPrimaryPos && info.hasSmallEyesPos) {
-            painter.setPen(QPen(QColor(255, 180, 80, 180), 1.5, Qt::DashLine));
-            painter.drawLine(toPixel(info.primaryPos), toPixel(info.smallEyesPos));
+            line.from = info.primaryPos;
+            line.to = info.smallEyesPos;
+            line.color = QColor(255, 180, 80, 180);
+            line.width = 1.5;
+            line.dashed = true;
+        } else {
+            continue;
         }
+        overlay.lines.append(line);
     }
 
     const QVector<KeymapEditorDocument::HandleInfo> handles = m_document->handleInfos(m_selectedNodeId);
-    painter.setFont(QFont(QStringLiteral("Microsoft YaHei UI"), 9));
     for (int i = 0; i < handles.size(); ++i) {
         const KeymapEditorDocument::HandleInfo &handle = handles.at(i);
-        const QPointF center = toPixel(handle.normalizedPos);
-        const QColor base = handle.readOnly ? QColor(120, 120, 120, 220)
-                                            : (handle.selected ? QColor(80, 170, 255, 240) : QColor(255, 255, 255, 220));
-        painter.setPen(QPen(QColor(20, 20, 20, 220), 2.0));
-        painter.setBrush(base);
-        painter.drawEllipse(center, kHandleRadius, kHandleRadius);
-        painter.setPen(QColor(240, 240, 240));
-        painter.drawText(QRectF(center.x() + 12.0, center.y() - 12.0, 140.0, 24.0), handle.label);
+        YuvOverlay::Marker marker;
+        marker.pos = handle.normalizedPos;
+        marker.color = handle.readOnly ? QColor(120, 120, 120, 220)
+                                       : (handle.selected ? QColor(80, 170, 255, 240) : QColor(255, 255, 255, 220));
+        marker.label = handle.label;
+        overlay.markers.append(marker);
     }
 }
 
+bool KeymapEditorOverlay::eventFilter(QObject *watched, QEvent *event)
+{
+    if (!m_active || watched != m_target) {
+        return QObject::eventFilter(watched, event);
+    }
+
+    // everything the mouse does on the video belongs to the editor while it is open
+    switch (event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonDblClick:
+        mousePressEvent(static_cast<QMouseEvent *>(event));
+        return true;
+    case QEvent::MouseMove:
+        mouseMoveEvent(static_cast<QMouseEvent *>(event));
+        return true;
+    case QEvent::MouseButtonRelease:
+        mouseReleaseEvent(static_cast<QMouseEvent *>(event));
+        return true;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
 void KeymapEditorOverlay::mousePressEvent(QMouseEvent *event)
 {
     if (!m_document || event->button() != Qt::LeftButton) {
-        QWidget::mousePressEvent(event);
         return;
     }
 
@@ -117,14 +158,13 @@ void KeymapEditorOverlay::mousePressEvent(QMouseEvent *event)
 
     m_selectedNodeId = -1;
     emit nodeSelected(-1);
-    update();
+    emit changed();
     event->accept();
 }
 
 void KeymapEditorOverlay::mouseMoveEvent(QMouseEvent *event)
 {
     if (!m_document || !m_dragging || !m_activeHandle.valid) {
-        QWidget::mouseMoveEvent(event);
         return;
     }
 
@@ -137,23 +177,23 @@ void KeymapEditorOverlay::mouseReleaseEvent(QMouseEvent *event)
     if (m_dragging && event->button() == Qt::LeftButton) {
         resetDragState();
         event->accept();
-        return;
     }
-    QWidget::mouseReleaseEvent(event);
 }
 
 QPointF KeymapEditorOverlay::toPixel(const QPointF &normalizedPos) const
 {
-    return QPointF(normalizedPos.x() * width(), normalizedPos.y() * height());
+    const QSize size = m_target ? m_target->size() : QSize();
+    return QPointF(normalizedPos.x() * size.width(), normalizedPos.y() * size.height());
 }
 
 QPointF KeymapEditorOverlay::toNormalized(const QPointF &pixelPos) const
 {
-    if (width() <= 0 || height() <= 0) {
+    const QSize size = m_target ? m_target->size() : QSize();
+    if (size.width() <= 0 || size.height() <= 0) {
         return QPointF(0.0, 0.0);
     }
-    const qreal x = qBound(0.0, pixelPos.x() / width(), 1.0);
-    const qreal y = qBound(0.0, pixelPos.y() / height(), 1.0);
+    const qreal x = qBound(0.0, pixelPos.x() / size.width(), 1.0);
+    const qreal y = qBound(0.0, pixelPos.y() / size.height(), 1.0);
     return QPointF(x, y);
 }
 
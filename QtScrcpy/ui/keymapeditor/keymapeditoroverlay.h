@@ -1,29 +1,40 @@
 #ifndef KEYMAPEDITOROVERLAY_H
 #define KEYMAPEDITOROVERLAY_H
 
+#include <QObject>
 #include <QPointer>
-#include <QWidget>
+#include <QPointF>
 
 #include "keymapeditordocument.h"
 
-class KeymapEditorOverlay : public QWidget
+class QMouseEvent;
+class QWidget;
+struct YuvOverlay;
+
+// Edits keymap handles on top of the video. It is not a widget: it filters
+// the video widget's mouse events while active and hands its markers to the
+// video renderer through appendTo(), which draws them with the frame.
+class KeymapEditorOverlay : public QObject
 {
     Q_OBJECT
 public:
-    explicit KeymapEditorOverlay(QWidget *parent = nullptr);
+    explicit KeymapEditorOverlay(QWidget *target, QObject *parent = nullptr);
 
     void setDocument(KeymapEditorDocument *document);
     void setSelectedNodeId(int nodeId);
     int selectedNodeId() const;
+    void setActive(bool active);
+    bool isActive() const;
+    // adds the dimming, drag lines and handles to the video overlay
+    void appendTo(YuvOverlay &overlay) const;
 
 signals:
     void nodeSelected(int nodeId);
+    // what appendTo() adds has changed
+    void changed();
 
 protected:
-    void paintEvent(QPaintEvent *event) override;
-    void mousePressEvent(QMouseEvent *event) override;
-    void mouseMoveEvent(QMouseEvent *event) override;
-    void mouseReleaseEvent(QMouseEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
     struct ActiveHandle {
@@ -32,15 +43,20 @@ private:
         bool valid = false;
     };
 
+    void mousePressEvent(QMouseEvent *event);
+    void mouseMoveEvent(QMouseEvent *event);
+    void mouseReleaseEvent(QMouseEvent *event);
     QPointF toPixel(const QPointF &normalizedPos) const;
     QPointF toNormalized(const QPointF &pixelPos) const;
     ActiveHandle hitTestHandle(const QPointF &pixelPos) const;
     void resetDragState();
 
+    QPointer<QWidget> m_target;
     QPointer<KeymapEditorDocument> m_document;
     int m_selectedNodeId = -1;
     ActiveHandle m_activeHandle;
     bool m_dragging = false;
+    bool m_active = false;
 };
 
 #endif // KEYMAPEDITOROVERLAY_H
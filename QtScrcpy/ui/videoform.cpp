@@ -24,6 +24,7 @@
 #include <cmath>
 #include <cstring>
 #include <functional>
+#include <utility>
 
 #if defined(Q_OS_WIN32)
 #include <Windows.h>
@@ -36,6 +37,8 @@
 #include "keymapeditor/keymapeditoroverlay.h"
 #include "keymapeditor/keymapeditorpanel.h"
 #include "qyuvopenglwidget.h"
+#include "qyuvopenglwindow.h"
+#include "qyuvsoftwarewidget.h"
 #include "thememanager.h"
 #include "toolform.h"
 #include "mousetap/mousetap.h"
@@ -55,6 +58,20 @@ constexpr int kRelativeLookConfigDebounceMs = 120;
 constexpr quint32 kAiDeltaMagic = 0x31444941U; // "AID1" little-endian
 constexpr quint16 kAiDeltaVersion = 1;
 constexpr quint16 kAiUdpPort = 12345;
+constexpr qreal kMagnifierSide = 180.0;
+constexpr qreal kMagnifierOffset = 24.0;
+constexpr int kAutoMaxSizeSettleMs = 1500;
+// copy rate of a window hidden for longer than BackgroundThrottle, keeps a recent frame to show
+constexpr int kBackgroundCopyIntervalMs = 1000;
+// a throttled window shown this long gets its session restored, the slowed one fills in until then
+constexpr int kBackgroundRestoreDelayMs = 3000;
+// least time between two background throttle restarts of a session
+constexpr qint64 kBackgroundChangeIntervalMs = 30000;
+// a frame this close behind the previous one was queued on the way, not captured like that
+constexpr qint64 kBurstGapMs = 4;
+// the stream is only resized once the window leaves this band around it
+constexpr qreal kAutoMaxSizeGrow = 1.15;
+constexpr qreal kAutoMaxSizeShrink = 0.6;
 
 class LocalTextInputOverlay final : public QLineEdit
 {
@@ -264,6 +281,50 @@ bool keymapEditorGeometryIntersectsVisibleScreen(const QRect &rect)
     }
     return false;
 }
+
+// Part of the decoded stream that lands in contentRect, or a null rect when the
+// whole frame is shown. Only a stream covering the full canvas (same aspect
+// ratio) has anything to cut; a stream the device already cropped maps 1:1.
+QRect buildStreamSourceRect(const QSize &streamSize, const QSize &canvasSize, const QRect &contentRect)
+{
+    if (streamSize.isEmpty() || canvasSize.isEmpty() || !contentRect.isValid()
+        || contentRect == QRect(QPoint(0, 0), canvasSize)) {
+        return QRect();
+    }
+
+    const qint64 streamCross = static_cast<qint64>(streamSize.width()) * canvasSize.height();
+    const qint64 canvasCross = static_cast<qint64>(canvasSize.width()) * streamSize.height();
+    // allow the rounding of a downscaled stream, about one percent
+    if (qAbs(streamCross - canvasCross) * 100 > canvasCross) {
+        return QRect();
+    }
+
+    const double scaleX = static_cast<double>(streamSize.width()) / canvasSize.width();
+    const double scaleY = static_cast<double>(streamSize.height()) / canvasSize.height();
+    // even coordinates, the 4:2:0 chroma planes are cut at half resolution
+    QRect sourceRect(qRound(contentRect.x() * scaleX) & ~1, qRound(contentRect.y() * scaleY) & ~1,
+                     qRound(contentRect.width() * scaleX) & ~1, qRound(contentRect.height() * scaleY) & ~1);
+    sourceRect = sourceRect.intersected(QRect(QPoint(0, 0), QSize(streamSize.width() & ~1, streamSize.height() & ~1)));
+    if (sourceRect.width() < 2 || sourceRect.height() < 2) {
+        return QRect();
+    }
+    return sourceRect;
+}
+
+// rect of a picture turned by quarterTurns clockwise, in the picture before the turn
+QRect unrotateRect(const QRect &rect, const QSize &rotatedSize, int quarterTurns)
+{
+    switch (quarterTurns) {
+    case 1:
+        return QRect(rect.y(), rotatedSize.width() - rect.x() - rect.width(), rect.height(), rect.width());
+    case 2:
+        return QRect(rotatedSize.width() - rect.x() - rect.width(), rotatedSize.height() - rect.y() - rect.height(), rect.width(), rect.height());
+    case 3:
+        return QRect(rotatedSize.height() - rect.y() - rect.height(), rect.x(), rect.height(), rect.width());
+    default:
+        return rect;
+    }
+}
 } // namespace
 
 #pragma pack(push, 1)
@@ -283,6 +344,9 @@ VideoForm::VideoForm(bool framelessWindow, bool skin, bool showToolbar, QWidget
     ui->setupUi(this);
     initUI();
     installShortcut();
+    loadZoomViewConfig();
+    m_autoMaxSize = 0 != Config::getInstance().getAutoMaxSize();
+    m_backgroundThrottleMs = qMax(0, Config::getInstance().getBackgroundThrottle()) * 1000;
     updateShowSize(size());
     bool vertical = size().height() > size().width();
     this->show_toolbar = showToolbar;
@@ -323,7 +387,19 @@ void VideoForm::initUI()
 #endif
     }
 
-    m_videoWidget = new QYUVOpenGLWidget();
+    if (YuvVideoRenderer::softwareRendering()) {
+        QYUVSoftwareWidget *softwareWidget = new QYUVSoftwareWidget();
+        m_videoRenderer = softwareWidget;
+        m_videoWidget = softwareWidget;
+    } else if (QYUVOpenGLWindow::nativeWindowEnabled()) {
+        QYUVOpenGLWindow *openGLWindow = new QYUVOpenGLWindow();
+        m_videoRenderer = openGLWindow;
+        m_videoWidget = openGLWindow->widget();
+    } else {
+        QYUVOpenGLWidget *openGLWidget = new QYUVOpenGLWidget();
+        m_videoRenderer = openGLWidget;
+        m_videoWidget = openGLWidget;
+    }
     m_videoWidget->hide();
     m_videoWidget->setFocusPolicy(Qt::StrongFocus);
     ui->keepRatioWidget->setWidget(m_videoWidget);
@@ -356,16 +432,6 @@ void VideoForm::initUI()
     });
     m_localTextInput = localTextInput;
 
-    m_fpsLabel = new QLabel(m_videoWidget);
-    QFont ft;
-    ft.setPointSize(15);
-    ft.setWeight(QFont::Light);
-    ft.setBold(true);
-    m_fpsLabel->setFont(ft);
-    m_fpsLabel->move(5, 15);
-    m_fpsLabel->setMinimumWidth(100);
-    m_fpsLabel->setStyleSheet(R"(QLabel {color: #00FF00;})");
-
     setMouseTracking(true);
     m_videoWidget->setMouseTracking(true);
     ui->keepRatioWidget->setMouseTracking(true);
@@ -461,15 +527,17 @@ void VideoForm::removeBlackRect()
 
 void VideoForm::showFPS(bool show)
 {
-    if (!m_fpsLabel) {
-        return;
-    }
-    m_fpsLabel->setVisible(show);
+    m_showFps = show;
+    updateVideoOverlay();
 }
 
 void VideoForm::updateRender(int width, int height, uint8_t* dataY, uint8_t* dataU, uint8_t* dataV, int linesizeY, int linesizeU, int linesizeV)
 {
-    m_streamFrameSize = QSize(width, height);
+    QElapsedTimer renderCallTimer;
+    renderCallTimer.start();
+
+    const QSize decodedFrameSize(width, height);
+    m_streamFrameSize = (m_clientRotation % 2) ? decodedFrameSize.transposed() : decodedFrameSize;
     if (!m_frameSize.isValid()) {
         updateShowSize(m_streamFrameSize);
     } else if (m_videoCenterCropSize <= 0 && m_lockDirectionIndex <= 0
@@ -500,15 +568,17 @@ void VideoForm::updateRender(int width, int height, uint8_t* dataY, uint8_t* dat
         }
     }
 
-    m_videoWidget->setStreamFrameSize(m_streamFrameSize);
-    applyVideoCanvasLayout();
-    positionKeymapEditorUi();
+    // window geometry changes relayout from resizeEvent/showEvent, frames only
+    // have to when the stream, canvas or crop changed
+    if (videoCanvasLayoutChanged()) {
+        applyVideoCanvasLayout();
+    }
 
     if (!m_videoSessionFirstFrameLogged && m_streamFrameSize.isValid() && isVisible()
         && m_videoWidget && m_videoWidget->size().isValid()
-        && m_videoWidget->framebufferPixelSize().isValid()) {
+        && m_videoRenderer->framebufferPixelSize().isValid()) {
         const QSize widgetLogicalSize = m_videoWidget ? m_videoWidget->size() : QSize();
-        const QSize framebufferPixelSize = m_videoWidget ? m_videoWidget->framebufferPixelSize() : QSize();
+        const QSize framebufferPixelSize = m_videoWidget ? m_videoRenderer->framebufferPixelSize() : QSize();
         const qreal devicePixelRatio = m_videoWidget ? m_videoWidget->devicePixelRatioF() : 1.0;
         qInfo() << "Video session first frame:"
                 << "widgetLogical=" << widgetLogicalSize
@@ -518,12 +588,46 @@ void VideoForm::updateRender(int width, int height, uint8_t* dataY, uint8_t* dat
                 << "streamFrame=" << m_streamFrameSize.width() << "x" << m_streamFrameSize.height()
                 << "cropSize=" << m_videoCenterCropSize
                 << "controlMapToScreen=" << m_controlMapToScreen
-                << "contentRect=" << m_contentRect;
+                << "contentRect=" << m_contentRect
+                << "sourceRect=" << m_videoSourceRect;
         m_videoSessionFirstFrameLogged = true;
     }
 
-    m_videoWidget->updateTextures(dataY, dataU, dataV, linesizeY, linesizeU, linesizeV);
-    updateNoVideoOverlay();
+    // the decoder planes are only valid during this call, copy them once into
+    // a pooled frame; with the pool exhausted the frame is dropped, not waited for
+    VideoFrameRef frame = m_videoRenderer->acquireFrame();
+    if (frame) {
+        const quint8 *const planes[3] = { dataY, dataU, dataV };
+        const quint32 strides[3] = { static_cast<quint32>(linesizeY), static_cast<quint32>(linesizeU), static_cast<quint32>(linesizeV) };
+        const QRect sourceRect = m_videoSourceRect.isValid() ? unrotateRect(m_videoSourceRect, m_streamFrameSize, m_clientRotation) : QRect();
+        if (!frame->fill(m_videoRenderer->pixelFormat(), decodedFrameSize, planes, strides, sourceRect)) {
+            frame.reset();
+        }
+    }
+    if (!videoExposed()) {
+        // nothing to show it on: keep the copy, skip the diff and the upload
+        if (!m_hiddenElapsed.isValid()) {
+            m_hiddenElapsed.start();
+        }
+        if (m_backgroundRestoreTimer) {
+            // hidden again before the restore, the session simply stays slowed
+            m_backgroundRestoreTimer->stop();
+        }
+        if (frame) {
+            if (m_deferredFrame) {
+                ++m_hiddenSkippedUploads;
+                m_hiddenSkippedBytes += static_cast<quint64>(m_deferredFrame->byteCount());
+            }
+            m_deferredFrame = std::move(frame);
+            m_hiddenCopyElapsed.start();
+        }
+    } else {
+        m_deferredFrame.reset();
+        m_videoRenderer->presentFrame(std::move(frame));
+    }
+
+    m_renderCallNsTotal += renderCallTimer.nsecsElapsed();
+    ++m_renderCallCount;
 }
 
 void VideoForm::applyVideoCanvasLayout()
@@ -546,10 +650,33 @@ void VideoForm::applyVideoCanvasLayout()
         m_contentRect = QRect(QPoint(0, 0), canvasSize);
     }
 
-    m_videoWidget->setCanvasSize(canvasSize);
-    m_videoWidget->setContentRect(m_contentRect);
+    // textures only hold the part of the stream that is visible
+    m_videoSourceRect = buildStreamSourceRect(m_streamFrameSize, canvasSize, m_contentRect);
+    if (m_streamFrameSize.isValid()) {
+        // the renderer gets the uploaded size and turns it itself
+        const QSize shownSize = m_videoSourceRect.isValid() ? m_videoSourceRect.size() : m_streamFrameSize;
+        m_videoRenderer->setStreamFrameSize((m_clientRotation % 2) ? shownSize.transposed() : shownSize);
+    }
+    m_videoRenderer->setRotation(m_clientRotation);
+    m_videoRenderer->setCanvasSize(canvasSize);
+    m_videoRenderer->setContentRect(m_contentRect);
     positionLocalTextInput();
-    positionKeymapEditorUi();
+
+    m_layoutStreamFrameSize = m_streamFrameSize;
+    m_layoutCanvasSize = m_frameSize;
+    m_layoutCropSize = m_videoCenterCropSize;
+    m_layoutControlMapToScreen = m_controlMapToScreen;
+    if (m_magnifierEnabled || !m_pipViews.isEmpty()) {
+        updateZoomViews();
+    }
+}
+
+bool VideoForm::videoCanvasLayoutChanged() const
+{
+    return m_streamFrameSize != m_layoutStreamFrameSize
+        || m_frameSize != m_layoutCanvasSize
+        || m_videoCenterCropSize != m_layoutCropSize
+        || m_controlMapToScreen != m_layoutControlMapToScreen;
 }
 void VideoForm::setSerial(const QString &serial)
 {
@@ -560,6 +687,7 @@ void VideoForm::setSerial(const QString &serial)
     bindDeviceRecordingState();
     resetOrientationProbeState();
     m_pendingInitialOrientation = -1;
+    m_deviceRotation = -1;
     reloadViewControlSeparationConfig();
     startOrientationPollingIfNeeded();
     updateNoVideoOverlay();
@@ -568,6 +696,9 @@ void VideoForm::setSerial(const QString &serial)
 void VideoForm::setInitialOrientationHint(int orientation)
 {
     m_pendingInitialOrientation = orientation;
+    if (orientation >= 0 && orientation <= 3) {
+        m_deviceRotation = orientation;
+    }
 }
 
 void VideoForm::setLocalTextInputConfig(bool enabled, const QKeySequence &shortcut)
@@ -881,6 +1012,15 @@ void VideoForm::installShortcut()
             emit device->setDeviceClipboard();
         }
     });
+    registerStandardShortcut(QKeySequence("Ctrl+Shift+m"), [this]() {
+        m_magnifierEnabled = !m_magnifierEnabled;
+        if (m_magnifierEnabled && m_videoWidget) {
+            const QPoint cursorPos = m_videoWidget->mapFromGlobal(QCursor::pos());
+            m_magnifierVisible = m_videoWidget->rect().contains(cursorPos);
+            m_magnifierPos = cursorPos;
+        }
+        updateZoomViews();
+    });
     registerStandardShortcut(QKeySequence("Ctrl+Shift+v"), [this]() {
         auto device = qsc::IDeviceManage::getInstance().getDevice(m_serial);
         if (device) {
@@ -898,8 +1038,8 @@ void VideoForm::ensureKeymapEditorUi()
     }
 
     if (!m_keymapEditorOverlay) {
-        m_keymapEditorOverlay = new KeymapEditorOverlay(ui->keepRatioWidget);
-        m_keymapEditorOverlay->hide();
+        m_keymapEditorOverlay = new KeymapEditorOverlay(m_videoWidget, this);
+        connect(m_keymapEditorOverlay, &KeymapEditorOverlay::changed, this, &VideoForm::updateVideoOverlay);
         connect(m_keymapEditorOverlay, &KeymapEditorOverlay::nodeSelected, this, [this](int nodeId) {
             if (m_keymapEditorPanel) {
                 m_keymapEditorPanel->setSelectedNodeId(nodeId);
@@ -931,18 +1071,141 @@ void VideoForm::ensureKeymapEditorUi()
     m_keymapEditorPanel->setCloseShortcut(m_keymapEditorKeySequence);
 }
 
-void VideoForm::positionKeymapEditorUi()
+void VideoForm::updateVideoOverlay()
 {
-    if (!m_keymapEditorOverlay) {
+    if (!m_videoWidget) {
+        return;
+    }
+
+    YuvOverlay overlay;
+    if (m_showFps) {
+        overlay.hudText = m_fpsText;
+    }
+    if (m_reconnecting) {
+        overlay.dimColor = QColor(0, 0, 0, 140);
+        overlay.hudText = tr("reconnecting...");
+    }
+    if (m_keymapEditorOverlay && m_keymapEditorOverlay->isActive()) {
+        m_keymapEditorOverlay->appendTo(overlay);
+    }
+    if (m_touchVisible) {
+        overlay.touchPoints.append(m_touchPos);
+    }
+    const QVector<YuvZoomView> &zoomViews = m_videoRenderer->zoomViews();
+    for (int i = 0; i < zoomViews.size(); ++i) {
+        const QRectF &target = zoomViews.at(i).target;
+        const QPointF corners[4] = { target.topLeft(), target.topRight(), target.bottomRight(), target.bottomLeft() };
+        for (int side = 0; side < 4; ++side) {
+            YuvOverlay::Line line;
+            line.from = corners[side];
+            line.to = corners[(side + 1) % 4];
+            line.color = QColor(255, 255, 255, 200);
+            line.width = 1.5;
+            overlay.lines.append(line);
+        }
+    }
+    m_videoRenderer->setOverlay(overlay);
+}
+
+void VideoForm::loadZoomViewConfig()
+{
+    m_magnifierZoom = qBound(2, Config::getInstance().getMagnifierZoom(), 16);
+    m_pipViews.clear();
+
+    // "sx,sy,sw,sh>tx,ty,tw,th;..." with source normalized to the frame and target to the video widget
+    const QStringList entries = Config::getInstance().getPipViews().split(';', Qt::SkipEmptyParts);
+    for (const QString &entry : entries) {
+        const QStringList rects = entry.split('>');
+        if (rects.size() != 2) {
+            qWarning() << "Invalid PipViews entry:" << entry;
+            continue;
+        }
+        qreal values[8] = {};
+        bool valid = true;
+        for (int r = 0; r < 2 && valid; ++r) {
+            const QStringList numbers = rects.at(r).split(',');
+            valid = numbers.size() == 4;
+            for (int n = 0; n < numbers.size() && valid; ++n) {
+                values[r * 4 + n] = numbers.at(n).trimmed().toDouble(&valid);
+            }
+        }
+        YuvZoomView view;
+        view.source = QRectF(values[0], values[1], values[2], values[3]);
+        view.target = QRectF(values[4], values[5], values[6], values[7]);
+        if (!valid || view.source.isEmpty() || view.target.isEmpty()) {
+            qWarning() << "Invalid PipViews entry:" << entry;
+            continue;
+        }
+        m_pipViews.append(view);
+    }
+    updateZoomViews();
+}
+
+void VideoForm::updateZoomViews()
+{
+    if (!m_videoRenderer) {
         return;
     }
 
-    QRect overlayRect = m_videoWidget ? m_videoWidget->geometry() : QRect();
-    if (!overlayRect.isValid() || overlayRect.isEmpty()) {
-        overlayRect = ui->keepRatioWidget->rect();
+    QVector<YuvZoomView> views = m_pipViews;
+    YuvZoomView magnifier;
+    if (m_magnifierEnabled && m_magnifierVisible && buildMagnifierView(magnifier)) {
+        views.append(magnifier);
     }
-    m_keymapEditorOverlay->setGeometry(overlayRect);
-    m_keymapEditorOverlay->raise();
+    m_videoRenderer->setZoomViews(views);
+    updateVideoOverlay();
+}
+
+bool VideoForm::buildMagnifierView(YuvZoomView &view) const
+{
+    const QSize canvasSize = m_frameSize.isValid() ? m_frameSize : m_streamFrameSize;
+    if (!m_videoWidget || !canvasSize.isValid() || canvasSize.isEmpty() || m_contentRect.isEmpty()
+        || m_videoWidget->width() <= 0 || m_videoWidget->height() <= 0) {
+        return false;
+    }
+
+    // the frame fills the content rect, here in widget pixels
+    const qreal widgetW = m_videoWidget->width();
+    const qreal widgetH = m_videoWidget->height();
+    const qreal scaleX = widgetW / canvasSize.width();
+    const qreal scaleY = widgetH / canvasSize.height();
+    const QRectF content(m_contentRect.x() * scaleX, m_contentRect.y() * scaleY, m_contentRect.width() * scaleX, m_contentRect.height() * scaleY);
+    if (!content.contains(m_magnifierPos)) {
+        return false;
+    }
+
+    const qreal side = qMin(kMagnifierSide, qMin(widgetW, widgetH) / 2);
+    const qreal sourceW = qMin(1.0, side / m_magnifierZoom / content.width());
+    const qreal sourceH = qMin(1.0, side / m_magnifierZoom / content.height());
+    const qreal sourceX = qBound(0.0, (m_magnifierPos.x() - content.x()) / content.width() - sourceW / 2, 1.0 - sourceW);
+    const qreal sourceY = qBound(0.0, (m_magnifierPos.y() - content.y()) / content.height() - sourceH / 2, 1.0 - sourceH);
+
+    // below right of the cursor, flipped when it would leave the widget
+    QPointF topLeft = m_magnifierPos + QPointF(kMagnifierOffset, kMagnifierOffset);
+    if (topLeft.x() + side > widgetW) {
+        topLeft.setX(m_magnifierPos.x() - kMagnifierOffset - side);
+    }
+    if (topLeft.y() + side > widgetH) {
+        topLeft.setY(m_magnifierPos.y() - kMagnifierOffset - side);
+    }
+    topLeft.setX(qBound(0.0, topLeft.x(), widgetW - side));
+    topLeft.setY(qBound(0.0, topLeft.y(), widgetH - side));
+
+    view.source = QRectF(sourceX, sourceY, sourceW, sourceH);
+    view.target = QRectF(topLeft.x() / widgetW, topLeft.y() / widgetH, side / widgetW, side / widgetH);
+    return true;
+}
+
+void VideoForm::setTouchIndicator(bool visible, const QPointF &videoPos)
+{
+    if (!visible && !m_touchVisible) {
+        return;
+    }
+    m_touchVisible = visible;
+    if (visible && m_videoWidget && m_videoWidget->width() > 0 && m_videoWidget->height() > 0) {
+        m_touchPos = QPointF(videoPos.x() / m_videoWidget->width(), videoPos.y() / m_videoWidget->height());
+    }
+    updateVideoOverlay();
 }
 
 QRect VideoForm::defaultKeymapEditorPanelGeometry() const
@@ -1036,16 +1299,14 @@ void VideoForm::setKeymapEditorActive(bool active)
             m_toolForm->hide();
         }
         ensureKeymapEditorUi();
-        positionKeymapEditorUi();
         restoreKeymapEditorPanelGeometry();
-        m_keymapEditorOverlay->show();
-        m_keymapEditorOverlay->raise();
+        m_keymapEditorOverlay->setActive(true);
         m_keymapEditorPanel->show();
         m_keymapEditorPanel->raise();
         m_keymapEditorPanel->activateWindow();
     } else {
         if (m_keymapEditorOverlay) {
-            m_keymapEditorOverlay->hide();
+            m_keymapEditorOverlay->setActive(false);
         }
         if (m_keymapEditorPanel) {
             saveKeymapEditorPanelGeometry();
@@ -1361,10 +1622,76 @@ bool VideoForm::isHost()
 void VideoForm::updateFPS(quint32 fps)
 {
     //qDebug() << "FPS:" << fps;
-    if (!m_fpsLabel) {
-        return;
-    }
-    m_fpsLabel->setText(QString("FPS:%1").arg(fps));
+    QString text = QString("FPS:%1").arg(fps);
+    qint64 presentLatencyUs = -1;
+    if (m_videoWidget) {
+        // per second deltas: frames that reached the screen and frames the presenter skipped
+        const YuvFramePresenter::Stats stats = m_videoRenderer->presentStats();
+        text += QString(" SHOW:%1 DROP:%2")
+                    .arg(stats.presented - m_lastPresentedFrames)
+                    .arg(stats.dropped - m_lastDroppedFrames);
+        m_lastPresentedFrames = stats.presented;
+        m_lastDroppedFrames = stats.dropped;
+
+        // share of frame bytes the band compare kept off the GPU
+        const quint64 frameBytes = stats.frameBytes - m_lastFrameBytes;
+        const quint64 uploadedBytes = stats.uploadedBytes - m_lastUploadedBytes;
+        if (frameBytes > 0) {
+            text += QString(" SKIP:%1%").arg(100 - uploadedBytes * 100 / frameBytes);
+        }
+        m_lastFrameBytes = stats.frameBytes;
+        m_lastUploadedBytes = stats.uploadedBytes;
+
+        // GPU cost per drawn frame, uploads and mipmaps included
+        const quint64 gpuDraws = stats.gpuDraws - m_lastGpuDraws;
+        if (gpuDraws > 0) {
+            text += QString(" GPU:%1us").arg((stats.gpuNs - m_lastGpuNs) / 1000 / gpuDraws);
+        }
+        m_lastGpuNs = stats.gpuNs;
+        m_lastGpuDraws = stats.gpuDraws;
+
+        // decoder to screen, the renderer's queueing and upload included;
+        // a cleared presenter starts its sums over
+        const quint64 latencyFrames = stats.latencyFrames >= m_lastLatencyFrames ? stats.latencyFrames - m_lastLatencyFrames : 0;
+        if (latencyFrames > 0 && stats.presentLatencyUs >= m_lastPresentLatencyUs) {
+            presentLatencyUs = static_cast<qint64>((stats.presentLatencyUs - m_lastPresentLatencyUs) / latencyFrames);
+            text += QString(" LAT:%1ms").arg(presentLatencyUs / 1000.0, 0, 'f', 1);
+        }
+        m_lastPresentLatencyUs = stats.presentLatencyUs;
+        m_lastLatencyFrames = stats.latencyFrames;
+
+        if (!m_startupReported && m_connectStartMsecs > 0 && m_firstDecodeMsecs > 0 && stats.firstPresentedMsecs > 0) {
+            // adb push, tunnel and server start all happen inside connectDevice
+            qInfo() << "Time to first frame:" << m_serial
+                    << "total=" << stats.firstPresentedMsecs - m_connectStartMsecs << "ms"
+                    << "connect=" << m_connectedMsecs - m_connectStartMsecs
+                    << "firstDecode=" << m_firstDecodeMsecs - m_connectedMsecs
+                    << "firstPresent=" << stats.firstPresentedMsecs - m_firstDecodeMsecs;
+            m_startupReported = true;
+        }
+    }
+    if (m_renderCallCount > 0) {
+        // average GUI thread cost of one decoded frame
+        text += QString(" UI:%1us").arg(m_renderCallNsTotal / 1000 / m_renderCallCount);
+        m_renderCallNsTotal = 0;
+        m_renderCallCount = 0;
+    }
+    if (m_lastReconnectMs > 0) {
+        text += QString(" RECONNECT:%1ms").arg(m_lastReconnectMs);
+    }
+    // hidden seconds, frames not uploaded or copied and their MB, of the last hidden stretch
+    text += m_backgroundSavingsText;
+    m_fpsText = text;
+    if (m_showFps) {
+        updateVideoOverlay();
+    }
+
+    // a stall still running at the tick counts too, the frames behind it are not here yet
+    const qint64 pendingGapMs = m_frameArrival.isValid() ? m_frameArrival.elapsed() : 0;
+    emit streamHealthSampled(m_serial, m_arrivedFrames, qMax(m_maxArrivalGapMs, pendingGapMs), m_burstFrames, presentLatencyUs);
+    m_arrivedFrames = 0;
+    m_maxArrivalGapMs = 0;
+    m_burstFrames = 0;
 }
 
 void VideoForm::grabCursor(bool grab)
@@ -1790,6 +2117,7 @@ void VideoForm::onOrientationProbeProcessError(QProcess::ProcessError error)
 
 void VideoForm::applyResolvedOrientation(int orientation)
 {
+    m_deviceRotation = orientation;
     if (m_lockDirectionIndex > 0) {
         if (m_frameSize.isValid() && !m_frameSize.isEmpty()) {
             m_orientationBaseReady = true;
@@ -1913,7 +2241,7 @@ QSize VideoForm::eventFrameSize() const
     }
 
     if (m_videoWidget) {
-        return m_videoWidget->frameSize();
+        return m_videoRenderer->frameSize();
     }
 
     return m_frameSize;
@@ -1921,16 +2249,75 @@ QSize VideoForm::eventFrameSize() const
 
 QSize VideoForm::eventShowSize() const
 {
+    // events are mapped back to the picture before setClientRotation(), see mapToStream()
+    QSize showSize = size();
     if (m_videoWidget && !m_videoWidget->size().isEmpty()) {
-        return m_videoWidget->size();
+        showSize = m_videoWidget->size();
     }
-    return size();
+    return (m_clientRotation % 2) ? showSize.transposed() : showSize;
+}
+
+QPointF VideoForm::mapToStream(const QPointF &videoPos) const
+{
+    if (0 == m_clientRotation || !m_videoWidget) {
+        return videoPos;
+    }
+
+    const qreal w = m_videoWidget->width();
+    const qreal h = m_videoWidget->height();
+    switch (m_clientRotation) {
+    case 1:
+        return QPointF(videoPos.y(), w - videoPos.x());
+    case 2:
+        return QPointF(w - videoPos.x(), h - videoPos.y());
+    case 3:
+        return QPointF(h - videoPos.y(), videoPos.x());
+    default:
+        return videoPos;
+    }
+}
+
+void VideoForm::setClientRotation(int quarterTurns)
+{
+    quarterTurns = ((quarterTurns % 4) + 4) % 4;
+    if (m_clientRotation == quarterTurns) {
+        return;
+    }
+
+    const bool transposed = ((quarterTurns - m_clientRotation) % 2) != 0;
+    qInfo() << "Client rotation changed:"
+            << "serial=" << m_serial
+            << "from=" << m_clientRotation * 90
+            << "to=" << quarterTurns * 90;
+    m_clientRotation = quarterTurns;
+    if (transposed && m_streamFrameSize.isValid()) {
+        m_streamFrameSize.transpose();
+        if (m_frameSize.isValid()) {
+            updateShowSize(m_frameSize.transposed());
+        }
+    }
+    applyVideoCanvasLayout();
+}
+
+int VideoForm::clientRotation() const
+{
+    return m_clientRotation;
+}
+
+int VideoForm::deviceRotation() const
+{
+    return m_deviceRotation;
 }
 
 void VideoForm::loadVideoEnabledConfig()
 {
     reloadViewControlSeparationConfig();
 }
+
+void VideoForm::reloadSessionConfig()
+{
+    reloadViewControlSeparationConfig();
+}
 void VideoForm::updateNoVideoOverlay()
 {
     if (!m_noVideoLabel || !ui || !ui->keepRatioWidget) {
@@ -2208,10 +2595,10 @@ void VideoForm::dispatchRawInputMouseMove(bool forceSend)
 
     const QPointF globalSentinel(kRawSyntheticGlobalSentinel, kRawSyntheticGlobalSentinel);
 #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-    QMouseEvent mouseEvent(QEvent::MouseMove, m_rawInputVirtualPos, globalSentinel,
+    QMouseEvent mouseEvent(QEvent::MouseMove, mapToStream(m_rawInputVirtualPos), globalSentinel,
                            Qt::NoButton, Qt::NoButton, Qt::NoModifier);
 #else
-    QMouseEvent mouseEvent(QEvent::MouseMove, m_rawInputVirtualPos, globalSentinel,
+    QMouseEvent mouseEvent(QEvent::MouseMove, mapToStream(m_rawInputVirtualPos), globalSentinel,
                            Qt::NoButton, Qt::NoButton, Qt::NoModifier);
 #endif
     emit device->mouseEvent(&mouseEvent, eventFrameSize(), eventShowSize());
@@ -2222,9 +2609,77 @@ void VideoForm::dispatchRawInputMouseMove(bool forceSend)
 
 void VideoForm::onFrame(int width, int height, uint8_t *dataY, uint8_t *dataU, uint8_t *dataV, int linesizeY, int linesizeU, int linesizeV)
 {
+    if (0 == m_firstDecodeMsecs) {
+        m_firstDecodeMsecs = startupClockMsecs();
+    }
+    if (m_frameArrival.isValid()) {
+        const qint64 gapMs = m_frameArrival.restart();
+        m_maxArrivalGapMs = qMax(m_maxArrivalGapMs, gapMs);
+        if (gapMs < kBurstGapMs) {
+            ++m_burstFrames;
+        }
+    } else {
+        m_frameArrival.start();
+    }
+    ++m_arrivedFrames;
+
+    const quint8 *const planes[3] = { dataY, dataU, dataV };
+    const quint32 strides[3] = { static_cast<quint32>(linesizeY), static_cast<quint32>(linesizeU), static_cast<quint32>(linesizeV) };
+    if (m_thumbnailer.update(planes, strides, QSize(width, height))) {
+        emit thumbnailUpdated(m_serial, m_thumbnailer.image());
+    }
+    // hidden past the grace period: the session is asked to slow down and
+    // the copy is only refreshed now and then
+    if (m_backgroundThrottleMs > 0 && m_hiddenElapsed.isValid()
+        && m_hiddenElapsed.elapsed() >= m_backgroundThrottleMs && !videoExposed()) {
+        if (!m_backgroundThrottled
+            && (!m_backgroundChangeElapsed.isValid() || m_backgroundChangeElapsed.elapsed() >= kBackgroundChangeIntervalMs)) {
+            m_backgroundThrottled = true;
+            m_backgroundChangeElapsed.start();
+            emit backgroundThrottleChanged(m_serial, true);
+        }
+        if (m_deferredFrame && m_hiddenCopyElapsed.elapsed() < kBackgroundCopyIntervalMs) {
+            ++m_hiddenSkippedCopies;
+            m_hiddenSkippedBytes += static_cast<quint64>(width) * static_cast<quint64>(height) * 3 / 2;
+            return;
+        }
+    }
     updateRender(width, height, dataY, dataU, dataV, linesizeY, linesizeU, linesizeV);
 }
 
+void VideoForm::setStartupTimes(qint64 connectStartMsecs, qint64 connectedMsecs)
+{
+    m_connectStartMsecs = connectStartMsecs;
+    m_connectedMsecs = connectedMsecs;
+}
+
+void VideoForm::setReconnecting(bool reconnecting, qint64 reconnectMs)
+{
+    m_reconnecting = reconnecting;
+    if (reconnecting) {
+        // nothing to send input to until the new session is attached
+        releaseGrabbedCursorState();
+        stopOrientationPolling();
+    } else {
+        m_lastReconnectMs = reconnectMs;
+        startOrientationPollingIfNeeded();
+    }
+    updateVideoOverlay();
+}
+
+bool VideoForm::closeRequested() const
+{
+    return m_closeRequested;
+}
+
+qint64 VideoForm::startupClockMsecs()
+{
+    // every QElapsedTimer shares the monotonic reference
+    QElapsedTimer clock;
+    clock.start();
+    return clock.msecsSinceReference();
+}
+
 void VideoForm::staysOnTop(bool top)
 {
     bool needShow = false;
@@ -2275,8 +2730,11 @@ void VideoForm::mousePressEvent(QMouseEvent *event)
             return;
         }
         QPointF mappedPos = m_videoWidget->mapFrom(this, localPos.toPoint());
-        QMouseEvent newEvent(event->type(), mappedPos, globalPos, event->button(), event->buttons(), event->modifiers());
+        QMouseEvent newEvent(event->type(), mapToStream(mappedPos), globalPos, event->button(), event->buttons(), event->modifiers());
         emit device->mouseEvent(&newEvent, eventFrameSize(), eventShowSize());
+        if (event->button() == Qt::LeftButton && !m_cursorGrabbed) {
+            setTouchIndicator(true, mappedPos);
+        }
 
         // debug keymap pos
         if (event->button() == Qt::LeftButton) {
@@ -2326,8 +2784,11 @@ void VideoForm::mouseReleaseEvent(QMouseEvent *event)
         if (local.y() > m_videoWidget->height()) {
             local.setY(m_videoWidget->height());
         }
-        QMouseEvent newEvent(event->type(), local, globalPos, event->button(), event->buttons(), event->modifiers());
+        QMouseEvent newEvent(event->type(), mapToStream(local), globalPos, event->button(), event->buttons(), event->modifiers());
         emit device->mouseEvent(&newEvent, eventFrameSize(), eventShowSize());
+        if (event->button() == Qt::LeftButton) {
+            setTouchIndicator(false);
+        }
     } else {
         m_dragPosition = QPoint(0, 0);
     }
@@ -2347,6 +2808,12 @@ void VideoForm::mouseMoveEvent(QMouseEvent *event)
         QPointF localPos = event->position();
         QPointF globalPos = event->globalPosition();
 #endif
+    if (m_magnifierEnabled) {
+        m_magnifierVisible = m_videoWidget->geometry().contains(event->pos());
+        m_magnifierPos = m_videoWidget->mapFrom(this, localPos.toPoint());
+        updateZoomViews();
+    }
+
     auto device = qsc::IDeviceManage::getInstance().getDevice(m_serial);
     if (m_videoWidget->geometry().contains(event->pos())) {
         if (m_rawInputActive && m_cursorGrabbed) {
@@ -2356,8 +2823,11 @@ void VideoForm::mouseMoveEvent(QMouseEvent *event)
             return;
         }
         QPointF mappedPos = m_videoWidget->mapFrom(this, localPos.toPoint());
-        QMouseEvent newEvent(event->type(), mappedPos, globalPos, event->button(), event->buttons(), event->modifiers());
+        QMouseEvent newEvent(event->type(), mapToStream(mappedPos), globalPos, event->button(), event->buttons(), event->modifiers());
         emit device->mouseEvent(&newEvent, eventFrameSize(), eventShowSize());
+        if (m_touchVisible && (event->buttons() & Qt::LeftButton)) {
+            setTouchIndicator(true, mappedPos);
+        }
     } else if (!m_dragPosition.isNull()) {
         if (event->buttons() & Qt::LeftButton) {
             move(globalPos.toPoint() - m_dragPosition);
@@ -2435,7 +2905,7 @@ void VideoForm::mouseDoubleClickEvent(QMouseEvent *event)
         QPointF globalPos = event->globalPosition();
 #endif
         QPointF mappedPos = m_videoWidget->mapFrom(this, localPos.toPoint());
-        QMouseEvent newEvent(event->type(), mappedPos, globalPos, event->button(), event->buttons(), event->modifiers());
+        QMouseEvent newEvent(event->type(), mapToStream(mappedPos), globalPos, event->button(), event->buttons(), event->modifiers());
         emit device->mouseEvent(&newEvent, eventFrameSize(), eventShowSize());
     }
 }
@@ -2455,7 +2925,7 @@ void VideoForm::wheelEvent(QWheelEvent *event)
         }
         QPointF pos = m_videoWidget->mapFrom(this, event->position().toPoint());
         QWheelEvent wheelEvent(
-            pos, event->globalPosition(), event->pixelDelta(), event->angleDelta(), event->buttons(), event->modifiers(), event->phase(), event->inverted());
+            mapToStream(pos), event->globalPosition(), event->pixelDelta(), event->angleDelta(), event->buttons(), event->modifiers(), event->phase(), event->inverted());
 #else
     if (m_videoWidget->geometry().contains(event->pos())) {
         if (!device) {
@@ -2464,7 +2934,7 @@ void VideoForm::wheelEvent(QWheelEvent *event)
         QPointF pos = m_videoWidget->mapFrom(this, event->pos());
 
         QWheelEvent wheelEvent(
-            pos, event->globalPosF(), event->pixelDelta(), event->angleDelta(), event->delta(), event->orientation(),
+            mapToStream(pos), event->globalPosF(), event->pixelDelta(), event->angleDelta(), event->delta(), event->orientation(),
             event->buttons(), event->modifiers(), event->phase(), event->source(), event->inverted());
 #endif
         emit device->wheelEvent(&wheelEvent, eventFrameSize(), eventShowSize());
@@ -2519,11 +2989,14 @@ void VideoForm::paintEvent(QPaintEvent *paint)
 void VideoForm::showEvent(QShowEvent *event)
 {
     QWidget::showEvent(event);
+    if (windowHandle()) {
+        // installed once however often the window is shown
+        windowHandle()->installEventFilter(this);
+    }
     applyTheme();
     ui->keepRatioWidget->relayoutNow();
     applyVideoCanvasLayout();
     positionLocalTextInput();
-    positionKeymapEditorUi();
     if (m_pendingVideoWidgetReveal && m_videoWidget) {
         if (m_loadingWidget) {
             m_loadingWidget->close();
@@ -2532,6 +3005,7 @@ void VideoForm::showEvent(QShowEvent *event)
         m_videoWidget->update();
         m_pendingVideoWidgetReveal = false;
     }
+    presentDeferredFrame();
     if (!isFullScreen() && this->show_toolbar) {
         QTimer::singleShot(500, this, [this](){
             showToolForm(this->show_toolbar);
@@ -2539,13 +3013,124 @@ void VideoForm::showEvent(QShowEvent *event)
     }
 }
 
+void VideoForm::changeEvent(QEvent *event)
+{
+    QWidget::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange && !isMinimized()) {
+        presentDeferredFrame();
+    }
+}
+
+bool VideoForm::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == windowHandle() && event->type() == QEvent::Expose) {
+        // isExposed() is updated once the window has handled the event
+        QTimer::singleShot(0, this, &VideoForm::presentDeferredFrame);
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+bool VideoForm::videoExposed() const
+{
+    if (!isVisible() || isMinimized()) {
+        return false;
+    }
+    // covered windows and other virtual desktops are unexposed where the platform reports it
+    const QWindow *window = windowHandle();
+    return !window || window->isExposed();
+}
+
+void VideoForm::presentDeferredFrame()
+{
+    if (!videoExposed()) {
+        return;
+    }
+    if (m_hiddenElapsed.isValid()) {
+        qInfo() << "background governor:" << m_serial
+                << "hidden" << m_hiddenElapsed.elapsed() << "ms"
+                << "uploadsSkipped=" << m_hiddenSkippedUploads
+                << "copiesSkipped=" << m_hiddenSkippedCopies
+                << "bytesSaved=" << m_hiddenSkippedBytes
+                << "throttled=" << m_backgroundThrottled;
+        m_backgroundSavingsText = QString(" BG:%1s/%2up/%3MB%4")
+                                      .arg(m_hiddenElapsed.elapsed() / 1000)
+                                      .arg(m_hiddenSkippedUploads + m_hiddenSkippedCopies)
+                                      .arg(m_hiddenSkippedBytes / (1024 * 1024))
+                                      .arg(m_backgroundThrottled ? QString("/slowed") : QString());
+        m_hiddenElapsed.invalidate();
+        m_hiddenCopyElapsed.invalidate();
+        m_hiddenSkippedUploads = 0;
+        m_hiddenSkippedCopies = 0;
+        m_hiddenSkippedBytes = 0;
+    }
+    if (m_backgroundThrottled) {
+        if (!m_backgroundRestoreTimer) {
+            m_backgroundRestoreTimer = new QTimer(this);
+            m_backgroundRestoreTimer->setSingleShot(true);
+            m_backgroundRestoreTimer->setInterval(kBackgroundRestoreDelayMs);
+            connect(m_backgroundRestoreTimer, &QTimer::timeout, this, &VideoForm::restoreBackgroundThrottle);
+        }
+        // the deferred frame and the slowed session cover a quick look
+        if (!m_backgroundRestoreTimer->isActive()) {
+            m_backgroundRestoreTimer->start();
+        }
+    }
+    if (m_deferredFrame) {
+        m_videoRenderer->presentFrame(std::move(m_deferredFrame));
+        m_deferredFrame.reset();
+    }
+}
+
+void VideoForm::restoreBackgroundThrottle()
+{
+    if (!m_backgroundThrottled || !videoExposed()) {
+        return;
+    }
+    m_backgroundThrottled = false;
+    m_backgroundChangeElapsed.start();
+    emit backgroundThrottleChanged(m_serial, false);
+}
+
+void VideoForm::scheduleAutoMaxSizeCheck()
+{
+    if (!m_autoMaxSize) {
+        return;
+    }
+    if (!m_autoMaxSizeTimer) {
+        m_autoMaxSizeTimer = new QTimer(this);
+        m_autoMaxSizeTimer->setSingleShot(true);
+        m_autoMaxSizeTimer->setInterval(kAutoMaxSizeSettleMs);
+        connect(m_autoMaxSizeTimer, &QTimer::timeout, this, &VideoForm::checkAutoMaxSize);
+    }
+    // restarted by every resize, a drag asks once it settles
+    m_autoMaxSizeTimer->start();
+}
+
+void VideoForm::checkAutoMaxSize()
+{
+    // a center crop magnifies part of the stream, its resolution is not what the window shows
+    if (!m_videoWidget || m_controlMapToScreen || !m_streamFrameSize.isValid() || !isVisible() || isMinimized()) {
+        return;
+    }
+
+    const QSize shownSize = m_videoWidget->size() * m_videoWidget->devicePixelRatioF();
+    const int shownLongSide = qMax(shownSize.width(), shownSize.height());
+    const int streamLongSide = qMax(m_streamFrameSize.width(), m_streamFrameSize.height());
+    if (shownLongSide <= 0 || streamLongSide <= 0) {
+        return;
+    }
+    if (shownLongSide > streamLongSide * kAutoMaxSizeGrow || shownLongSide < streamLongSide * kAutoMaxSizeShrink) {
+        qInfo() << "auto max size:" << m_serial << "shows" << shownLongSide << "px of a" << streamLongSide << "px stream";
+        emit maxSizeSuggested(m_serial, shownLongSide);
+    }
+}
+
 void VideoForm::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
     updateNoVideoOverlay();
     ui->keepRatioWidget->relayoutNow();
     positionLocalTextInput();
-    positionKeymapEditorUi();
     if (isVisible() && m_streamFrameSize.isValid()) {
         applyVideoCanvasLayout();
         if (m_pendingVideoWidgetReveal && m_videoWidget) {
@@ -2558,6 +3143,7 @@ void VideoForm::resizeEvent(QResizeEvent *event)
         if (m_videoWidget) {
             m_videoWidget->update();
         }
+        scheduleAutoMaxSizeCheck();
     }
     QSize goodSize = ui->keepRatioWidget->goodSize();
     if (goodSize.isEmpty()) {
@@ -2585,6 +3171,7 @@ void VideoForm::resizeEvent(QResizeEvent *event)
 void VideoForm::closeEvent(QCloseEvent *event)
 {
     Q_UNUSED(event)
+    m_closeRequested = true;
     shutdownKeymapEditor(false);
     releaseGrabbedCursorState();
     stopOrientationPolling();
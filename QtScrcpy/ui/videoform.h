@@ -13,6 +13,9 @@
 #include <QWidget>
 
 #include "../QtScrcpyCore/include/QtScrcpyCore.h"
+#include "videoframe.h"
+#include "yuvvideorenderer.h"
+#include "yuvthumbnailer.h"
 
 namespace Ui
 {
@@ -23,7 +26,7 @@ class ToolForm;
 class FileHandler;
 class QLineEdit;
 class QShortcut;
-class QYUVOpenGLWidget;
+class YuvVideoRenderer;
 class QLabel;
 class KeymapEditorDocument;
 class KeymapEditorOverlay;
@@ -40,8 +43,26 @@ public:
     void updateRender(int width, int height, uint8_t* dataY, uint8_t* dataU, uint8_t* dataV, int linesizeY, int linesizeU, int linesizeV);
     void setSerial(const QString& serial);
     void setInitialOrientationHint(int orientation);
+    // re-reads VideoEnabled and the center crop, for a new session attached to this window
+    void reloadSessionConfig();
+    // Connect click and deviceConnected on startupClockMsecs(), the first
+    // decode and present of this session are logged against them.
+    void setStartupTimes(qint64 connectStartMsecs, qint64 connectedMsecs);
+    static qint64 startupClockMsecs();
+    // AutoReconnect: the device dropped, the last frame stays dimmed until a
+    // new session is attached; reconnectMs is shown with the FPS stats
+    void setReconnecting(bool reconnecting, qint64 reconnectMs = 0);
+    // closed by the user, the disconnect that follows is no drop
+    bool closeRequested() const;
     void setLocalTextInputConfig(bool enabled, const QKeySequence &shortcut);
     void setKeymapEditorShortcut(const QKeySequence &shortcut);
+    // Turns the picture by clockwise quarter turns on this side, input is
+    // mapped back; the stream itself is not touched.
+    void setClientRotation(int quarterTurns);
+    int clientRotation() const;
+    // Android display rotation (counter-clockwise quarter turns) from the
+    // initial orientation hint or the orientation poller, -1 while unknown
+    int deviceRotation() const;
     void setScriptBinding(const QString &filePath, const QString &displayName, const QString &json);
     QRect getGrabCursorRect();
     const QSize &frameSize();
@@ -53,6 +74,17 @@ public:
 
 signals:
     void restartServiceRequested(const QString &serial);
+    // a low rate preview of the stream, see YuvThumbnailer::image()
+    void thumbnailUpdated(const QString &serial, const QImage &thumbnail);
+    // AutoMaxSize: the window shows longSide device pixels, far from the stream resolution
+    void maxSizeSuggested(const QString &serial, int longSide);
+    // frame arrivals of the last second, see BitRateController::Sample
+    // presentLatencyUs: average decode to present time of the second, -1 without presented frames
+    void streamHealthSampled(const QString &serial, quint32 frames, qint64 maxGapMs, quint32 burstFrames, qint64 presentLatencyUs);
+    // hidden past BackgroundThrottle, or shown for a few seconds after that:
+    // the session's fps and bitrate are worth lowering, or restoring. Never
+    // lowered again within 30 seconds of the last change.
+    void backgroundThrottleChanged(const QString &serial, bool throttled);
 
 private:
     void onFrame(int width, int height, uint8_t* dataY, uint8_t* dataU, uint8_t* dataV,
@@ -68,6 +100,15 @@ private:
     void applyTheme();
     void reloadViewControlSeparationConfig();
     void applyVideoCanvasLayout();
+    bool videoCanvasLayoutChanged() const;
+    // m_videoWidget position to the unrotated picture of eventShowSize()
+    QPointF mapToStream(const QPointF &videoPos) const;
+    // visible, not minimized and not reported covered by the window system
+    bool videoExposed() const;
+    void presentDeferredFrame();
+    void restoreBackgroundThrottle();
+    void scheduleAutoMaxSizeCheck();
+    void checkAutoMaxSize();
     void resetOrientationProbeState();
     void resetOrientationProbeTask();
     void initOrientationPoller();
@@ -99,7 +140,12 @@ private:
     void setRawInputActive(bool active);
     void dispatchRawInputMouseMove(bool forceSend = false);
     void ensureKeymapEditorUi();
-    void positionKeymapEditorUi();
+    // pushes the FPS text, keymap editor markers and touch point to the renderer
+    void updateVideoOverlay();
+    void loadZoomViewConfig();
+    void updateZoomViews();
+    bool buildMagnifierView(YuvZoomView &view) const;
+    void setTouchIndicator(bool visible, const QPointF &videoPos = QPointF());
     QRect defaultKeymapEditorPanelGeometry() const;
     QRect normalizeKeymapEditorPanelGeometry(const QRect &requested) const;
     void restoreKeymapEditorPanelGeometry();
@@ -134,6 +180,8 @@ protected:
 
     void paintEvent(QPaintEvent *) override;
     void showEvent(QShowEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
     void closeEvent(QCloseEvent *event) override;
 
@@ -150,8 +198,9 @@ private:
     Ui::videoForm *ui;
     QPointer<ToolForm> m_toolForm;
     QPointer<QWidget> m_loadingWidget;
-    QPointer<QYUVOpenGLWidget> m_videoWidget;
-    QPointer<QLabel> m_fpsLabel;
+    // QYUVOpenGLWidget or QYUVSoftwareWidget, m_videoRenderer lives as long as m_videoWidget
+    QPointer<QWidget> m_videoWidget;
+    YuvVideoRenderer *m_videoRenderer = nullptr;
     QPointer<QLabel> m_noVideoLabel;
     QPointer<QLineEdit> m_localTextInput;
     QPointer<QShortcut> m_localTextInputShortcut;
@@ -183,10 +232,73 @@ private:
     int m_videoCenterCropSize = 0;
     int m_lockDirectionIndex = 0;
     bool m_videoSessionFirstFrameLogged = false;
+    quint64 m_lastPresentedFrames = 0;
+    quint64 m_lastDroppedFrames = 0;
+    quint64 m_lastFrameBytes = 0;
+    quint64 m_lastUploadedBytes = 0;
+    quint64 m_lastGpuNs = 0;
+    quint64 m_lastGpuDraws = 0;
+    quint64 m_lastPresentLatencyUs = 0;
+    quint64 m_lastLatencyFrames = 0;
+    QString m_fpsText;
+    bool m_showFps = true;
+    // left button held on the video, normalized to m_videoWidget
+    bool m_touchVisible = false;
+    QPointF m_touchPos;
+    // GUI thread time spent in updateRender since the last FPS tick
+    qint64 m_renderCallNsTotal = 0;
+    quint32 m_renderCallCount = 0;
+    // time to first frame, on startupClockMsecs()
+    qint64 m_connectStartMsecs = 0;
+    qint64 m_connectedMsecs = 0;
+    qint64 m_firstDecodeMsecs = 0;
+    bool m_startupReported = false;
+    bool m_reconnecting = false;
+    qint64 m_lastReconnectMs = 0;
+    bool m_closeRequested = false;
+    // decoded frame arrivals since the last FPS tick
+    QElapsedTimer m_frameArrival;
+    quint32 m_arrivedFrames = 0;
+    qint64 m_maxArrivalGapMs = 0;
+    quint32 m_burstFrames = 0;
+    YuvThumbnailer m_thumbnailer;
+    // PipViews from the config, plus the magnifier around the cursor (m_videoWidget pixels)
+    QVector<YuvZoomView> m_pipViews;
+    bool m_magnifierEnabled = false;
+    bool m_magnifierVisible = false;
+    QPointF m_magnifierPos;
+    int m_magnifierZoom = 3;
+    // newest frame while the window is hidden or minimized, shown when it comes back
+    VideoFrameRef m_deferredFrame;
+    // background governor: how long the window has been hidden and what that saved
+    int m_backgroundThrottleMs = 0;
+    QElapsedTimer m_hiddenElapsed;
+    QElapsedTimer m_hiddenCopyElapsed;
+    quint64 m_hiddenSkippedUploads = 0;
+    quint64 m_hiddenSkippedCopies = 0;
+    quint64 m_hiddenSkippedBytes = 0;
+    bool m_backgroundThrottled = false;
+    // each change restarts the session: shown windows are restored once they
+    // stay shown, and hidden ones are not slowed again right after a restore
+    QTimer *m_backgroundRestoreTimer = nullptr;
+    QElapsedTimer m_backgroundChangeElapsed;
+    // what the last hidden stretch saved, for the FPS stats
+    QString m_backgroundSavingsText;
     bool m_pendingVideoWidgetReveal = false;
+    // as shown, so transposed from the decoded frames for odd m_clientRotation
     QSize m_streamFrameSize;
+    int m_clientRotation = 0;
     QRect m_contentRect;
+    // stream pixels behind m_contentRect, null when the whole frame is uploaded
+    QRect m_videoSourceRect;
+    // inputs of the last applyVideoCanvasLayout(), frames only relayout when they change
+    QSize m_layoutStreamFrameSize;
+    QSize m_layoutCanvasSize;
+    int m_layoutCropSize = -1;
+    bool m_layoutControlMapToScreen = false;
     QTimer *m_orientationPollTimer = nullptr;
+    bool m_autoMaxSize = false;
+    QTimer *m_autoMaxSizeTimer = nullptr;
     QPointer<QTimer> m_orientationProbeStepTimer;
     QPointer<QTimer> m_orientationProbeBudgetTimer;
     QPointer<QProcess> m_orientationProbeProcess;
@@ -199,6 +311,7 @@ private:
     int m_orientationBaseValue = -1;
     bool m_orientationBaseReady = false;
     int m_pendingInitialOrientation = -1;
+    int m_deviceRotation = -1;
     bool m_localTextInputEnabled = true;
     QKeySequence m_localTextInputKeySequence = QKeySequence(QStringLiteral("Ctrl+Shift+T"));
     QKeySequence m_keymapEditorKeySequence = QKeySequence(QStringLiteral("Ctrl+E"));
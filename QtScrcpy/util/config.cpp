@@ -33,6 +33,51 @@
 #define COMMON_DESKTOP_OPENGL_KEY "UseDesktopOpenGL"
 #define COMMON_DESKTOP_OPENGL_DEF -1
 
+#define COMMON_RENDER_BACKEND_KEY "RenderBackend"
+#define COMMON_RENDER_BACKEND_DEF "Auto"
+
+#define COMMON_RENDER_THREAD_KEY "RenderThread"
+#define COMMON_RENDER_THREAD_DEF 1
+
+#define COMMON_PRESENT_POLICY_KEY "PresentPolicy"
+#define COMMON_PRESENT_POLICY_DEF "Smooth"
+
+#define COMMON_SCALE_QUALITY_KEY "ScaleQuality"
+#define COMMON_SCALE_QUALITY_DEF "Linear"
+
+#define COMMON_VIDEO_SURFACE_KEY "VideoSurface"
+#define COMMON_VIDEO_SURFACE_DEF "Widget"
+
+#define COMMON_SWAP_INTERVAL_KEY "SwapInterval"
+#define COMMON_SWAP_INTERVAL_DEF 1
+
+#define COMMON_DEVICE_WALL_KEY "DeviceWall"
+#define COMMON_DEVICE_WALL_DEF 0
+
+#define COMMON_MAGNIFIER_ZOOM_KEY "MagnifierZoom"
+#define COMMON_MAGNIFIER_ZOOM_DEF 3
+
+#define COMMON_PIP_VIEWS_KEY "PipViews"
+#define COMMON_PIP_VIEWS_DEF ""
+
+#define COMMON_AUTO_MAX_SIZE_KEY "AutoMaxSize"
+#define COMMON_AUTO_MAX_SIZE_DEF 0
+
+#define COMMON_BACKGROUND_THROTTLE_KEY "BackgroundThrottle"
+#define COMMON_BACKGROUND_THROTTLE_DEF 10
+
+#define COMMON_ADAPTIVE_BITRATE_KEY "AdaptiveBitRate"
+#define COMMON_ADAPTIVE_BITRATE_DEF 0
+
+#define COMMON_ADAPTIVE_BITRATE_MIN_KEY "AdaptiveBitRateMin"
+#define COMMON_ADAPTIVE_BITRATE_MIN_DEF 2000000
+
+#define COMMON_ADAPTIVE_LATENCY_TARGET_KEY "AdaptiveLatencyTarget"
+#define COMMON_ADAPTIVE_LATENCY_TARGET_DEF 150
+
+#define COMMON_AUTO_RECONNECT_KEY "AutoReconnect"
+#define COMMON_AUTO_RECONNECT_DEF 0
+
 #define COMMON_SKIN_KEY "UseSkin"
 #define COMMON_SKIN_DEF 1
 
@@ -141,6 +186,9 @@
 #define SERIAL_NORMAL_MOUSE_CURSOR_FLUSH_INTERVAL_MS_KEY "NormalMouseCursorFlushIntervalMs"
 #define SERIAL_NORMAL_MOUSE_CURSOR_CLICK_SUPPRESSION_MS_KEY "NormalMouseCursorClickSuppressionMs"
 #define SERIAL_NORMAL_MOUSE_TAP_MIN_HOLD_MS_KEY "NormalMouseTapMinHoldMs"
+#define SERIAL_ENCODERS_KEY "Encoders"
+#define SERIAL_CODEC_NAME_KEY "CodecName"
+#define SERIAL_CODEC_PRESET_KEY "CodecPreset"
 
 // IP history
 #define IP_HISTORY_KEY "IpHistory"
@@ -496,6 +544,84 @@ void Config::clearDeviceCenterCropSize(const QString &serial)
     m_userData->sync();
 }
 
+QStringList Config::getDeviceEncoders(const QString &serial)
+{
+    const QString trimmedSerial = serial.trimmed();
+    if (trimmedSerial.isEmpty()) {
+        return QStringList();
+    }
+
+    m_userData->beginGroup(trimmedSerial);
+    const QStringList encoders = m_userData->value(SERIAL_ENCODERS_KEY).toStringList();
+    m_userData->endGroup();
+    return encoders;
+}
+
+void Config::setDeviceEncoders(const QString &serial, const QStringList &encoders)
+{
+    const QString trimmedSerial = serial.trimmed();
+    if (trimmedSerial.isEmpty()) {
+        return;
+    }
+
+    m_userData->beginGroup(trimmedSerial);
+    m_userData->setValue(SERIAL_ENCODERS_KEY, encoders);
+    m_userData->endGroup();
+    m_userData->sync();
+}
+
+QString Config::getDeviceCodecName(const QString &serial)
+{
+    const QString trimmedSerial = serial.trimmed();
+    if (trimmedSerial.isEmpty()) {
+        return QString();
+    }
+
+    m_userData->beginGroup(trimmedSerial);
+    const QString codecName = m_userData->value(SERIAL_CODEC_NAME_KEY).toString();
+    m_userData->endGroup();
+    return codecName;
+}
+
+void Config::setDeviceCodecName(const QString &serial, const QString &codecName)
+{
+    const QString trimmedSerial = serial.trimmed();
+    if (trimmedSerial.isEmpty()) {
+        return;
+    }
+
+    m_userData->beginGroup(trimmedSerial);
+    m_userData->setValue(SERIAL_CODEC_NAME_KEY, codecName);
+    m_userData->endGroup();
+    m_userData->sync();
+}
+
+QString Config::getDeviceCodecPreset(const QString &serial)
+{
+    const QString trimmedSerial = serial.trimmed();
+    if (trimmedSerial.isEmpty()) {
+        return QString();
+    }
+
+    m_userData->beginGroup(trimmedSerial);
+    const QString preset = m_userData->value(SERIAL_CODEC_PRESET_KEY).toString();
+    m_userData->endGroup();
+    return preset;
+}
+
+void Config::setDeviceCodecPreset(const QString &serial, const QString &preset)
+{
+    const QString trimmedSerial = serial.trimmed();
+    if (trimmedSerial.isEmpty()) {
+        return;
+    }
+
+    m_userData->beginGroup(trimmedSerial);
+    m_userData->setValue(SERIAL_CODEC_PRESET_KEY, preset);
+    m_userData->endGroup();
+    m_userData->sync();
+}
+
 DeviceMouseConfig Config::getDeviceMouseConfig(const QString &serial)
 {
     DeviceMouseConfig config;
@@ -667,6 +793,141 @@ int Config::getDesktopOpenGL()
     return opengl;
 }
 
+QString Config::getRenderBackend()
+{
+    QString backend;
+    m_settings->beginGroup(GROUP_COMMON);
+    backend = m_settings->value(COMMON_RENDER_BACKEND_KEY, COMMON_RENDER_BACKEND_DEF).toString();
+    m_settings->endGroup();
+    return backend;
+}
+
+int Config::getRenderThread()
+{
+    int renderThread = 1;
+    m_settings->beginGroup(GROUP_COMMON);
+    renderThread = m_settings->value(COMMON_RENDER_THREAD_KEY, COMMON_RENDER_THREAD_DEF).toInt();
+    m_settings->endGroup();
+    return renderThread;
+}
+
+QString Config::getPresentPolicy()
+{
+    QString policy;
+    m_settings->beginGroup(GROUP_COMMON);
+    policy = m_settings->value(COMMON_PRESENT_POLICY_KEY, COMMON_PRESENT_POLICY_DEF).toString();
+    m_settings->endGroup();
+    return policy;
+}
+
+QString Config::getScaleQuality()
+{
+    QString quality;
+    m_settings->beginGroup(GROUP_COMMON);
+    quality = m_settings->value(COMMON_SCALE_QUALITY_KEY, COMMON_SCALE_QUALITY_DEF).toString();
+    m_settings->endGroup();
+    return quality;
+}
+
+QString Config::getVideoSurface()
+{
+    QString surface;
+    m_settings->beginGroup(GROUP_COMMON);
+    surface = m_settings->value(COMMON_VIDEO_SURFACE_KEY, COMMON_VIDEO_SURFACE_DEF).toString();
+    m_settings->endGroup();
+    return surface;
+}
+
+int Config::getSwapInterval()
+{
+    int interval = COMMON_SWAP_INTERVAL_DEF;
+    m_settings->beginGroup(GROUP_COMMON);
+    interval = m_settings->value(COMMON_SWAP_INTERVAL_KEY, COMMON_SWAP_INTERVAL_DEF).toInt();
+    m_settings->endGroup();
+    return interval;
+}
+
+int Config::getDeviceWall()
+{
+    int wall = COMMON_DEVICE_WALL_DEF;
+    m_settings->beginGroup(GROUP_COMMON);
+    wall = m_settings->value(COMMON_DEVICE_WALL_KEY, COMMON_DEVICE_WALL_DEF).toInt();
+    m_settings->endGroup();
+    return wall;
+}
+
+int Config::getMagnifierZoom()
+{
+    int zoom = COMMON_MAGNIFIER_ZOOM_DEF;
+    m_settings->beginGroup(GROUP_COMMON);
+    zoom = m_settings->value(COMMON_MAGNIFIER_ZOOM_KEY, COMMON_MAGNIFIER_ZOOM_DEF).toInt();
+    m_settings->endGroup();
+    return zoom;
+}
+
+QString Config::getPipViews()
+{
+    QString views;
+    m_settings->beginGroup(GROUP_COMMON);
+    views = m_settings->value(COMMON_PIP_VIEWS_KEY, COMMON_PIP_VIEWS_DEF).toString();
+    m_settings->endGroup();
+    return views;
+}
+
+int Config::getAutoMaxSize()
+{
+    int autoMaxSize = COMMON_AUTO_MAX_SIZE_DEF;
+    m_settings->beginGroup(GROUP_COMMON);
+    autoMaxSize = m_settings->value(COMMON_AUTO_MAX_SIZE_KEY, COMMON_AUTO_MAX_SIZE_DEF).toInt();
+    m_settings->endGroup();
+    return autoMaxSize;
+}
+
+int Config::getBackgroundThrottle()
+{
+    int seconds = COMMON_BACKGROUND_THROTTLE_DEF;
+    m_settings->beginGroup(GROUP_COMMON);
+    seconds = m_settings->value(COMMON_BACKGROUND_THROTTLE_KEY, COMMON_BACKGROUND_THROTTLE_DEF).toInt();
+    m_settings->endGroup();
+    return seconds;
+}
+
+int Config::getAdaptiveBitRate()
+{
+    int adaptive = COMMON_ADAPTIVE_BITRATE_DEF;
+    m_settings->beginGroup(GROUP_COMMON);
+    adaptive = m_settings->value(COMMON_ADAPTIVE_BITRATE_KEY, COMMON_ADAPTIVE_BITRATE_DEF).toInt();
+    m_settings->endGroup();
+    return adaptive;
+}
+
+quint32 Config::getAdaptiveBitRateMin()
+{
+    quint32 bitRate = COMMON_ADAPTIVE_BITRATE_MIN_DEF;
+    m_settings->beginGroup(GROUP_COMMON);
+    bitRate = m_settings->value(COMMON_ADAPTIVE_BITRATE_MIN_KEY, COMMON_ADAPTIVE_BITRATE_MIN_DEF).toUInt();
+    m_settings->endGroup();
+    return bitRate;
+}
+
+int Config::getAdaptiveLatencyTarget()
+{
+    int latencyMs = COMMON_ADAPTIVE_LATENCY_TARGET_DEF;
+    m_settings->beginGroup(GROUP_COMMON);
+    latencyMs = m_settings->value(COMMON_ADAPTIVE_LATENCY_TARGET_KEY, COMMON_ADAPTIVE_LATENCY_TARGET_DEF).toInt();
+    m_settings->endGroup();
+    return latencyMs;
+}
+
+int Config::getAutoReconnect()
+{
+    int autoReconnect = COMMON_AUTO_RECONNECT_DEF;
+    m_settings->beginGroup(GROUP_COMMON);
+    autoReconnect = m_settings->value(COMMON_AUTO_RECONNECT_KEY, COMMON_AUTO_RECONNECT_DEF).toInt();
+    m_settings->endGroup();
+    return autoReconnect;
+}
+
 int Config::getSkin()
 {
     // force disable skin
@@ -66,6 +66,21 @@ public:
     int getGlobalMaxFps();
     int getMaxFps();
     int getDesktopOpenGL();
+    QString getRenderBackend();
+    int getRenderThread();
+    QString getPresentPolicy();
+    QString getScaleQuality();
+    QString getVideoSurface();
+    int getSwapInterval();
+    int getDeviceWall();
+    int getMagnifierZoom();
+    QString getPipViews();
+    int getAutoMaxSize();
+    int getBackgroundThrottle();
+    int getAdaptiveBitRate();
+    quint32 getAdaptiveBitRateMin();
+    int getAdaptiveLatencyTarget();
+    int getAutoReconnect();
     int getSkin();
     int getRenderExpiredFrames();
     QString getPushFilePath();
@@ -93,6 +108,14 @@ public:
     int getDeviceCenterCropSize(const QString &serial);
     void setDeviceCenterCropSize(const QString &serial, int cropSize);
     void clearDeviceCenterCropSize(const QString &serial);
+    // probed "mime name" encoder list, see EncoderProbe
+    QStringList getDeviceEncoders(const QString &serial);
+    void setDeviceEncoders(const QString &serial, const QStringList &encoders);
+    // used when the global CodecName / CodecOptions are empty
+    QString getDeviceCodecName(const QString &serial);
+    void setDeviceCodecName(const QString &serial, const QString &codecName);
+    QString getDeviceCodecPreset(const QString &serial);
+    void setDeviceCodecPreset(const QString &serial, const QString &preset);
     DeviceMouseConfig getDeviceMouseConfig(const QString &serial);
     void ensureDeviceMouseConfigInitialized(const QString &serial);
     void setDeviceMouseConfig(const QString &serial, const DeviceMouseConfig &config);